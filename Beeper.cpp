@@ -0,0 +1,100 @@
+//
+//  Beeper.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Beeper.h"
+
+#include <math.h>
+#include <string.h>
+
+Beeper::Beeper(int sampleRate, int timerRate, size_t ringSamples) : ring(ringSamples), sampleRate(sampleRate), timerRate(timerRate)
+{
+    sampleCredit = 0;
+    phase = 0;
+    overruns = 0;
+    underruns = 0;
+
+    memset(pattern, 0xF0, sizeof(pattern));
+    setPitch(64);
+}
+
+void Beeper::setPattern(const uint8_t* newPattern)
+{
+    memcpy(pattern, newPattern, sizeof(pattern));
+}
+
+void Beeper::setPitch(uint8_t pitch)
+{
+    //XO-CHIP: 4000 bits a second at 64, an octave every 48
+    phaseStep = 4000.0 * pow(2.0, (pitch - 64) / 48.0) / sampleRate;
+}
+
+void Beeper::tick(bool startsOn, const float* edges, int edgeCount)
+{
+    sampleCredit += sampleRate;
+    long count = sampleCredit / timerRate;
+    sampleCredit -= count * timerRate;
+
+    //Made in small pieces on the stack so nothing is allocated per tick
+    int16_t chunk [256];
+    bool on = startsOn;
+    int edge = 0;
+    long done = 0;
+
+    while (done < count)
+    {
+        long length = count - done < 256 ? count - done : 256;
+
+        for (long i = 0; i < length; i++)
+        {
+            //Centre of the sample against where Fx18 happened, so a tone started halfway through the frame
+            //starts halfway through its samples
+            float position = (done + i + 0.5f) / count;
+
+            while (edge < edgeCount && edges[edge] <= position)
+            {
+                on = !on;
+                edge++;
+            }
+
+            if (on)
+            {
+                int bit = (int) phase;
+                bool high = (pattern[bit >> 3] >> (7 - (bit & 7))) & 1;
+                chunk[i] = high ? volume : -volume;
+
+                phase += phaseStep;
+
+                if (phase >= 128)
+                    phase -= 128;
+            }
+            else
+            {
+                chunk[i] = 0;
+            }
+        }
+
+        size_t pushed = ring.push(chunk, length);
+
+        //Running ahead of the device (turbo, or it stalled), the rest of this tick is lost
+        if (pushed < (size_t) length)
+            overruns.fetch_add((long) (length - pushed), std::memory_order_relaxed);
+
+        done += length;
+    }
+}
+
+void Beeper::fill(int16_t* out, size_t count)
+{
+    size_t popped = ring.pop(out, count);
+
+    if (popped < count)
+    {
+        memset(out + popped, 0, (count - popped) * sizeof(int16_t));
+        underruns.fetch_add((long) (count - popped), std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,60 @@
+//
+//  Beeper.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Beeper__
+#define __Chip8__Beeper__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "Frontend.h"
+#include "SampleRing.h"
+
+//Turns the sound timer into samples. tick runs on the emulation thread and pushes into the ring, fill runs on
+//the audio thread and takes them out, neither locks or allocates. The tone is the XO-CHIP 1 bit pattern, 128 bits
+//played at the pitch rate - the default one is a 500Hz square, which is about what the original beeper did
+class Beeper : public Audio
+{
+public:
+    //ringSamples is the most that can be queued ahead of the audio device, which is also the worst latency
+    Beeper (int sampleRate, int timerRate, size_t ringSamples);
+
+    void tick (bool startsOn, const float* edges, int edgeCount) override;
+
+    //XO-CHIP F002 and Fx3A
+    void setPattern (const uint8_t* newPattern) override;
+    void setPitch (uint8_t pitch) override;
+    void setTimerRate (int newTimerRate) { timerRate = newTimerRate; }
+
+    //Audio thread, fills count samples and makes up anything the ring doesn't have with silence
+    void fill (int16_t* out, size_t count);
+
+    //Samples dropped because the ring was full, and asked for when it was empty
+    long getOverruns () const { return overruns.load(std::memory_order_relaxed); }
+    long getUnderruns () const { return underruns.load(std::memory_order_relaxed); }
+
+    static const int16_t volume = 6000;
+
+private:
+    SampleRing ring;
+    int sampleRate;
+    int timerRate;
+    //Samples owed to the next tick, in 1/timerRate steps
+    long sampleCredit;
+
+    uint8_t pattern [16];
+    //Position in the pattern and how far it moves per sample, in bits
+    double phase;
+    double phaseStep;
+
+    std::atomic<long> overruns;
+    std::atomic<long> underruns;
+};
+
+#endif /* defined(__Chip8__Beeper__) */
@@ -0,0 +1,214 @@
+//
+//  BenchRoms.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "BenchRoms.h"
+
+#include <stdio.h>
+
+using namespace std;
+
+//Just enough of an assembler to lay the ROMs out - opcodes go in one after another from 0x200
+struct RomWriter
+{
+    vector<uint8_t> data;
+
+    uint16_t here () const { return (uint16_t) (0x200 + data.size()); }
+
+    void op (uint16_t opcode)
+    {
+        data.push_back((uint8_t) (opcode >> 8));
+        data.push_back((uint8_t) opcode);
+    }
+
+    //Fills in the address of an opcode written earlier with a 0 address
+    void patch (uint16_t at, uint16_t address)
+    {
+        size_t offset = at - 0x200;
+        data[offset] = (uint8_t) ((data[offset] & 0xF0) | (address >> 8));
+        data[offset + 1] = (uint8_t) address;
+    }
+};
+
+static BenchRom makeAlu ()
+{
+    RomWriter rom;
+
+    for (int x = 0; x < 6; x++)
+        rom.op(0x6000 | x << 8 | (x * 5 + 1));
+
+    uint16_t loop = rom.here();
+
+    rom.op(0x8014);     //ADD V0, V1
+    rom.op(0x8125);     //SUB V1, V2
+    rom.op(0x8233);     //XOR V2, V3
+    rom.op(0x8341);     //OR V3, V4
+    rom.op(0x8452);     //AND V4, V5
+    rom.op(0x8506);     //SHR V5
+    rom.op(0x850E);     //SHL V5
+    rom.op(0x8017);     //SUBN V0, V1
+    rom.op(0x7307);     //ADD V3, 7
+    rom.op(0x7501);     //ADD V5, 1
+    rom.op(0x3400);     //SE V4, 0
+    rom.op(0x8404);     //ADD V4, V0
+    rom.op(0x9450);     //SNE V4, V5
+    rom.op(0x8154);     //ADD V1, V5
+    rom.op(0xC7FF);     //RND V7
+    rom.op(0x1000 | loop);
+
+    return {"alu", "8XYN arithmetic, skips and RND in a tight loop", rom.data};
+}
+
+static BenchRom makeDraw ()
+{
+    RomWriter rom;
+    uint16_t setSprite = rom.here();
+    rom.op(0xA000);
+
+    uint16_t loop = rom.here();
+
+    rom.op(0x7003);     //ADD V0, 3
+    rom.op(0x7105);     //ADD V1, 5
+    rom.op(0xD01F);     //DRW V0, V1, 15
+    rom.op(0x7207);     //ADD V2, 7
+    rom.op(0x730B);     //ADD V3, 11
+    rom.op(0xD23F);     //DRW V2, V3, 15
+    rom.op(0xD01F);
+    rom.op(0xD23F);
+    rom.op(0x7401);     //ADD V4, 1
+    rom.op(0x4400);     //SNE V4, 0 - clear once every 256 trips
+    rom.op(0x00E0);
+    rom.op(0x1000 | loop);
+
+    rom.patch(setSprite, rom.here());
+
+    const uint8_t sprite [] = {0xFF, 0x81, 0xBD, 0xA5, 0xA5, 0xBD, 0x81, 0xFF, 0x18, 0x3C, 0x7E, 0xFF, 0x7E, 0x3C, 0x18};
+    rom.data.insert(rom.data.end(), sprite, sprite + sizeof(sprite));
+
+    return {"draw", "15 row sprites drawn and erased across wrapping edges", rom.data};
+}
+
+static BenchRom makeCalls ()
+{
+    const int depth = 8;
+    RomWriter rom;
+
+    uint16_t loop = rom.here();
+    //Each subroutine is 3 opcodes after the 3 of the main loop
+    rom.op(0x2000 | (loop + 6));
+    rom.op(0x7F01);
+    rom.op(0x1000 | loop);
+
+    for (int level = 0; level < depth; level++)
+    {
+        rom.op(0x7001 | level << 8);
+
+        if (level + 1 < depth)
+            rom.op(0x2000 | (rom.here() + 4));
+        else
+            rom.op(0x6F00);
+
+        rom.op(0x00EE);
+    }
+
+    return {"calls", "2NNN/00EE chains eight deep", rom.data};
+}
+
+static BenchRom makeMemory ()
+{
+    RomWriter rom;
+
+    uint16_t loop = rom.here();
+
+    rom.op(0x7801);     //ADD V8, 1
+    rom.op(0xA600);     //LD I, 0x600 - well clear of the code
+    rom.op(0xF833);     //LD B, V8
+    rom.op(0xF265);     //LD V0-V2, [I]
+    rom.op(0xF555);     //LD [I], V0-V5
+    rom.op(0x6A10);     //LD VA, 16
+    rom.op(0xFA1E);     //ADD I, VA
+    rom.op(0xFF55);     //LD [I], V0-VF
+    rom.op(0xFF65);     //LD V0-VF, [I]
+    rom.op(0xF929);     //LD F, V9
+    rom.op(0xF833);
+    rom.op(0x1000 | loop);
+
+    return {"memory", "BCD and Fx55/Fx65 bursts", rom.data};
+}
+
+static BenchRom makeScroll ()
+{
+    RomWriter rom;
+
+    uint16_t loop = rom.here();
+
+    rom.op(0x00FF);     //HIGH - 128x64, clears the display
+    uint16_t setBig = rom.here();
+    rom.op(0xA000);
+    rom.op(0x6138);     //LD V1, 56 - the bottom half of a 16x16 sprite goes off the edge
+    rom.op(0xD010);     //DRW V0, V1, 0
+    rom.op(0xD010);     //Again, VF counts the 8 rows that were drawn and none of the clipped ones
+    rom.op(0x82F4);     //ADD V2, VF
+    rom.op(0x00C3);     //SCD 3
+    rom.op(0x00FB);     //SCR
+    rom.op(0xD010);
+    rom.op(0x82F4);
+    rom.op(0x00FC);     //SCL
+    rom.op(0x7005);     //ADD V0, 5
+    rom.op(0x00FE);     //LOW - 64x32, scrolls move whole low resolution pixels
+    uint16_t setSmall = rom.here();
+    rom.op(0xA000);
+    rom.op(0x631C);     //LD V3, 28 - half of an 8 row sprite off the edge
+    rom.op(0xD038);     //DRW V0, V3, 8
+    rom.op(0x00C2);     //SCD 2
+    rom.op(0x00FB);
+    rom.op(0xD038);
+    rom.op(0x82F4);
+    rom.op(0x00FC);
+    rom.op(0x00FC);
+    rom.op(0x1000 | loop);
+
+    rom.patch(setBig, rom.here());
+
+    for (int row = 0; row < 16; row++)
+    {
+        rom.data.push_back((uint8_t) (0xFF >> (row % 8)));
+        rom.data.push_back((uint8_t) (0xFF << (row % 8)));
+    }
+
+    rom.patch(setSmall, rom.here());
+
+    const uint8_t sprite [] = {0x3C, 0x42, 0x81, 0xA5, 0x81, 0x99, 0x42, 0x3C};
+    rom.data.insert(rom.data.end(), sprite, sprite + sizeof(sprite));
+
+    return {"scroll", "SUPER-CHIP scrolls in both resolutions and 16x16 sprites clipped at the bottom", rom.data, MODE_SCHIP};
+}
+
+vector<BenchRom> makeBenchRoms ()
+{
+    return {makeAlu(), makeDraw(), makeCalls(), makeMemory(), makeScroll()};
+}
+
+bool writeBenchRoms (const vector<BenchRom>& roms, const char* directory)
+{
+    for (const BenchRom& rom : roms)
+    {
+        const char* extensions [] = {".ch8", ".sc8", ".xo8"};
+        string location = string(directory) + "/" + rom.name + extensions[rom.mode];
+        FILE* file = fopen(location.c_str(), "wb");
+
+        if (file == nullptr)
+            return false;
+
+        bool written = fwrite(rom.data.data(), 1, rom.data.size(), file) == rom.data.size();
+
+        if (fclose(file) != 0 || !written)
+            return false;
+    }
+
+    return true;
+}
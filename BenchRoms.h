@@ -0,0 +1,34 @@
+//
+//  BenchRoms.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__BenchRoms__
+#define __Chip8__BenchRoms__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Decode.h"
+
+//Small generated ROMs that each hammer one part of the machine, for the benchmark suite. Every one loops forever
+//without settling into anything idle loop skipping can shortcut, so the numbers are real work
+struct BenchRom
+{
+    std::string name;
+    std::string description;
+    std::vector<uint8_t> data;
+    //Set before loading, the data means nothing on another machine
+    Mode mode = MODE_CHIP8;
+};
+
+std::vector<BenchRom> makeBenchRoms ();
+
+//Writes each one out as DIRECTORY/name.ch8 (.sc8 for SUPER-CHIP, .xo8 for XO-CHIP), false if any couldn't be written
+bool writeBenchRoms (const std::vector<BenchRom>& roms, const char* directory);
+
+#endif /* defined(__Chip8__BenchRoms__) */
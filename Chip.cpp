@@ -11,50 +11,23 @@
 using namespace std;
 using namespace SDL2pp;
 
-#define disp(x, y) display[y * displayWidth + x]
-
-Chip::Chip () : memoryStart(0x200), memorySize(0xfff), distribution(0, 255), displayHeight(32), displayWidth(32)
+Chip::Chip (bool softwareRenderer, const char* audioDriver, bool presentOnVsync)
 {
-    memset(memory, 0, memorySize);
-    memset(registers, 0, sizeof(registers));
-    memset(stack, 0, sizeof(stack));
-    memset(display, 0, sizeof(display));
-    
-    displayWidth = 64;
-    displayHeight = 32;
     pixelSize = 10;
-    drawFlag = true;
-    
-    I = 0;
-    pc = memoryStart;
-    sp = 0;
-    
-    st = 0;
-    dt = 0;
-
-    //Framerate in Hz
-    frameRate =  60;
-    
-    //Read sprite data into interpreter memory (0x0 - 0x200)
-    //Sprites start at position 0 and are 5 bytes each
-    unsigned char hexChars [] = {
-                    0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
-                    0x20, 0x60, 0x20, 0x20, 0x70, // 1
-                    0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
-                    0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
-                    0x90, 0x90, 0xF0, 0x10, 0x10, // 4
-                    0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
-                    0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
-                    0xF0, 0x10, 0x20, 0x40, 0x40, // 7
-                    0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
-                    0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
-                    0xF0, 0x90, 0xF0, 0x90, 0x90, // A
-                    0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
-                    0xF0, 0x80, 0x80, 0x80, 0xF0, // C
-                    0xE0, 0x90, 0x90, 0x90, 0xE0, // D
-                    0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
-                    0xF0, 0x80, 0xF0, 0x80, 0x80 // F
-    };
+    quit = false;
+    running = false;
+    keys = 0;
+    rewindHeld = false;
+    pressedKey = -1;
+    software = softwareRenderer;
+    vsync = presentOnVsync;
+    lastVsync = 0;
+    counterFrequency = SDL_GetPerformanceFrequency();
+    memset(shown, 0, sizeof(shown));
+    
+    textureWidth = 0;
+    textureHeight = 0;
+    shownPlanes = 0;
     
     //Lookup for converting between Chip8 keyboard and SDL
     keyLookup = {
@@ -63,15 +36,16 @@ Chip::Chip () : memoryStart(0x200), memorySize(0xfff), distribution(0, 255), dis
             SDL_SCANCODE_A, SDL_SCANCODE_S, SDL_SCANCODE_D, SDL_SCANCODE_F,
             SDL_SCANCODE_Z, SDL_SCANCODE_X, SDL_SCANCODE_C, SDL_SCANCODE_V
     };
-
-    for (int i = 0; i < sizeof(hexChars); i++)
-    {
-        memory[i] = hexChars[i];
-    }
+    
+    //Cheap enough to leave on, a few microseconds a frame
+    setRewindBudget(8 * 1024 * 1024);
     
     initSDL();
-
-    fileLoaded = false;
+    initAudio(audioDriver);
+    
+    core.setInput(this);
+    core.setVideo(this);
+    core.setTimer(this);
 }
 
 Chip::~Chip()
@@ -82,8 +56,14 @@ Chip::~Chip()
 void Chip::initSDL()
 {
     sdl = make_unique<SDL>(SDL_INIT_VIDEO);
-    window = make_unique<Window>("Chip 8", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, displayWidth * pixelSize, displayHeight * pixelSize, SDL_WINDOW_RESIZABLE);
-    renderer = make_unique<Renderer>(*window.get(), -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+    window = make_unique<Window>("Chip 8", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, core.getDisplayWidth() * pixelSize, core.getDisplayHeight() * pixelSize, SDL_WINDOW_RESIZABLE);
+    Uint32 rendererFlags = software ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE;
+    
+    if (vsync)
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    
+    renderer = make_unique<Renderer>(*window.get(), -1, rendererFlags);
+    core.getPacer().setVsyncAlignment(vsync);
     
     renderer->SetDrawBlendMode(SDL_BLENDMODE_BLEND);
     
@@ -92,630 +72,381 @@ void Chip::initSDL()
     renderer->Clear();
 }
 
-void Chip::loadFile(char *location)
+void Chip::initAudio(const char* driver)
 {
-    ifstream file;
-    file.open(location, ios::binary | ios::ate);
+    const int sampleRate = 44100;
     
-    if (file.is_open())
+    if (driver != nullptr)
+        SDL_setenv("SDL_AUDIODRIVER", driver, 1);
+    
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
     {
-        size_t fileSize = file.tellg();
-        
-        file.seekg(ios::beg);
-        
-        file.read((char*) &memory[memoryStart], fileSize);
-        
-        fileLoaded = true;
-        
-        other.loadApplication(location);
-//        size_t position = memoryStart;
-//        
-//        while (position < fileSize)
-//        {
-//            position += disassembleChip8(&memory[position]);
-//        }
+        cerr << "No audio: " << SDL_GetError() << endl;
+        return;
     }
-    else
-    {
-        cerr << "Error opening file" << endl;
-        exit(1);
-    }
-}
-
-void Chip::emulate()
-{
-    if (fileLoaded)
+    
+    //About 50ms queued at most, more just makes the sound lag the picture
+    beeper = make_unique<Beeper>(sampleRate, core.getTimerRate(), 2048);
+    
+    try
     {
-        Uint32 secondCounter = 0;
+        Beeper* source = beeper.get();
         
-        while (1)
+        audioDevice = make_unique<AudioDevice>(NullOpt, false, AudioSpec(sampleRate, AUDIO_S16SYS, 1, 512),
+                                               [source] (Uint8* stream, int length)
         {
-            //Get time
-            Uint32 blockStartTime = SDL_GetTicks();
-            
-            if (secondCounter == 0)
-                secondCounter = blockStartTime;
-            else if (secondCounter + 1000 < blockStartTime)
-            {
-                //printf("FPS: %d\n", fps);
-                fps = 0;
-                secondCounter = blockStartTime;
-            }
-            
-            // Process input
-            SDL_Event event;
-            //poll event also calls pumpevent which refreshes keyboardstate
-            while (SDL_PollEvent(&event))
-                if (event.type == SDL_QUIT ||
-                    (event.type == SDL_KEYDOWN && (event.key.keysym.sym == SDLK_ESCAPE)))
-                    return;
-            
-            
-            for (int i = 0; i < 9; i++)
-            {
-                //emulate cycle
-                emulateCycle();
-            }
-            
-            renderDisplay();
-            fps++;
-            
-            //Update timers
-            if (dt > 0)
-                dt--;
-            
-            if (st > 0)
-                st--;
-            
-            //Get time
-            //minus time to see how long this block took
-            int timeElapsed = SDL_GetTicks() - blockStartTime;
-            
-            //Keeps a steady rendering framerate
-            int delay = 1000/frameRate;
-            
-            if (delay - timeElapsed > 0)
-            {
-                // Frame limiter
-                SDL_Delay((1000/frameRate) - timeElapsed);
-            }
-        }
+            source->fill((int16_t*) stream, length / sizeof(int16_t));
+        });
     }
-    else
+    catch (Exception& e)
     {
-        cerr << "A game file must be loaded before emulation" << endl;
-        exit(1);
+        cerr << "No audio: " << e.what() << endl;
+        beeper.reset();
+        return;
     }
+    
+    core.setAudio(beeper.get());
+    audioDevice->Pause(false);
 }
 
-void Chip::renderDisplay()
+void Chip::loadFile(char *location)
 {
-    if (drawFlag)
-    {
-        // Clear screen
-        renderer->SetDrawColor(0, 0, 0);
-        renderer->Clear();
-        
-        renderer->SetDrawColor(255, 255, 255);
-        for (int y = 0; y < displayHeight; y++)
-        {
-            for (int x = 0; x < displayWidth; x++)
-            {
-                if (display[(y * displayWidth) + x] == 1)
-                {
-                    int startX = x * pixelSize;
-                    int startY = y * pixelSize;
-                    renderer->FillRect(startX, startY, startX + pixelSize, startY + pixelSize);
-                }
-            }
-        }
+    if (!core.loadFile(location))
+        exit(1);
     
-        renderer->Present();
-    }
+    if (rewind != nullptr)
+        rewind->clear();
 }
 
-bool Chip::setPixel(int x, int y)
+void Chip::setRewindBudget(size_t budget)
 {
-    //Wrap around
-    if (x > displayWidth)
-        x -= displayWidth;
-    
-    if (y > displayHeight)
-        y -= displayHeight;
-    
-    //XOR-ed on, if this causes any pixels to be erased return 1
-    disp(x, y) ^= 1;
-    
-    return !disp(x, y);
+    if (budget > 0)
+        rewind = make_unique<Rewind>(budget);
+    else
+        rewind.reset();
 }
 
-unsigned short Chip::getHex (unsigned short opcode, uint8_t position, uint8_t length)
+void Chip::emulate()
 {
-    //Size of the opcode not including position 0
-    const uint8_t opcodeSize = 4;
+    quit = false;
+    running = true;
     
-    assert(length > 0);
-    //Position starts at 0, must be between 0-3
-    assert(position <= opcodeSize);
-    //Position + length must be less than size of the opcode
-    assert((position + length) <= opcodeSize);
+    thread emulation(&Chip::emulationLoop, this);
     
-    //Returns the value at (position) in opcode, value will be (length) nibbles long
-    int mask = 0x0;
-    int addedCount = 0;
-    
-    for (int i = 0; i < opcodeSize; i++)
+    while (running)
     {
-        if (i >= position && addedCount < length)
+        SDL_Event event;
+        
+        //Short wait so a new frame is never left waiting long, events wake it straight away
+        if (SDL_WaitEventTimeout(&event, 1))
         {
-            mask |= (0xf << ((opcodeSize - 1) - i) * 4);
-            addedCount++;
+            handleEvent(event);
+            
+            while (SDL_PollEvent(&event))
+                handleEvent(event);
         }
-        else
-            mask |= (0x0 << ((opcodeSize - 1) - i) * 4);
+        
+        flushEvents();
+        
+        if (frames.update())
+            presentLatest();
     }
     
-    return (opcode & mask) >> ((opcodeSize - (position + length)) * 4);
-}
-
-unsigned char Chip::random()
-{
-    return distribution(generator);
-}
-
-long Chip::lookupScancode(SDL_Scancode code)
-{
-    return find(keyLookup.begin(), keyLookup.end(), code) - keyLookup.begin();
+    emulation.join();
+    
+    //Whatever it drew last before stopping
+    if (frames.update())
+        presentLatest();
+    
+    if (core.getStatus() == STATUS_UNHANDLED_OPCODE)
+    {
+        printf("Unhandled %x\n", core.getUnhandledOpcode());
+        exit(1);
+    }
+    
+    if (rewind != nullptr)
+        printf("Rewind: %zu frames in %zu KB, %.2f us per frame\n",
+               rewind->getFrames(), rewind->getBytesUsed() / 1024, rewind->getAverageRecordTime());
+    
+    Pacer& pacer = core.getPacer();
+    
+    if (pacer.getWaits() > 0)
+        printf("Pacing: %.1f us late on average, %.1f us deviation, %.1f us worst, %ld of %ld ticks late, %ld resyncs\n",
+               pacer.getJitterMean(), pacer.getJitterDeviation(), pacer.getJitterMax(), pacer.getLateTicks(),
+               pacer.getWaits(), pacer.getResyncs());
+    
+    if (beeper != nullptr)
+        printf("Audio: %ld samples dropped, %ld short\n", beeper->getOverruns(), beeper->getUnderruns());
 }
 
-void Chip::hex0 (unsigned short opcode)
+void Chip::emulationLoop()
 {
-    switch (opcode)
+    while (true)
     {
-        case 0x00E0:
-            printf("Clear the display\n");
-            memset(display, 0, sizeof(display));
-            drawFlag = true;
+        core.run();
+        
+        if (core.getStatus() == STATUS_UNHANDLED_OPCODE)
             break;
-        case 0x00EE:
-            //printf("Return from subroutine\n");
-            pc = stack[--sp];
+        
+        //Still running - the input side asked to stop
+        if (core.getStatus() != STATUS_HALTED)
             break;
-        default:
-            //0x0NNN
-            //printf("Execute machine subroutine %x\n", getHex(opcode, 1, 3));
+        
+        //Program has stopped itself - leave its last frame up until the window is closed, or rewind takes it
+        //back to before it stopped
+        core.renderDisplay();
+        
+        while (pollEvents() && core.getStatus() == STATUS_HALTED)
+            SDL_Delay(10);
+        
+        if (quit || core.getStatus() == STATUS_HALTED)
             break;
     }
+    
+    running = false;
 }
 
-void Chip::goToAddress (unsigned short opcode)
+void Chip::handleEvent(const SDL_Event& event)
 {
-    //first nibble = 1 or 2
-    //1 = jump, 2 = call
-    if (getHex(opcode, 0, 1) == 0x2)
+    if (event.type == SDL_QUIT ||
+        (event.type == SDL_KEYDOWN && (event.key.keysym.sym == SDLK_ESCAPE)))
+        quit = true;
+    else if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && !event.key.repeat)
     {
-        //printf("Execute subroutine at %3x\n", getHex(opcode, 1, 3));
-        //CALL
-        //Save program counter to stack
-        stack[sp] = pc;
-        sp++;
-    }
-    else
-    {
-        //printf("Jump to %3x\n", getHex(opcode, 1, 3));
+        bool down = event.type == SDL_KEYDOWN;
+        long chipKey = lookupScancode(event.key.keysym.scancode);
+        
+        if (chipKey < (long) keyLookup.size())
+            queueEvent({(uint8_t) (down ? INPUT_KEY_DOWN : INPUT_KEY_UP), (uint8_t) chipKey});
+        else if (event.key.keysym.scancode == SDL_SCANCODE_BACKSPACE)
+            queueEvent({(uint8_t) (down ? INPUT_REWIND_DOWN : INPUT_REWIND_UP), 0});
     }
-    //Goto
-    unsigned short address = getHex(opcode, 1, 3);
+    //The core only renders when the display changes, so put the last frame back up if the window lost it
+    else if (event.type == SDL_WINDOWEVENT &&
+             (event.window.event == SDL_WINDOWEVENT_EXPOSED || event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED))
+        present();
+}
 
-    if (address < memoryStart)
-    {
-        printf("Accessing interpreter memory space\n");
-    }
+void Chip::queueEvent(InputEvent event)
+{
+    //Behind ones that didn't fit last time, so they still arrive in order
+    pendingEvents.push_back(event);
+    flushEvents();
+}
 
-    pc = address;
-    jumpFlag = true;
+void Chip::flushEvents()
+{
+    //The emulation thread has fallen behind and the queue is full - anything that doesn't fit is kept and tried
+    //again, a lost key up would leave the key held forever
+    while (!pendingEvents.empty() && events.push(pendingEvents.front()))
+        pendingEvents.pop_front();
 }
 
-void Chip::skipNextInstruction (unsigned short opcode)
+void Chip::drainEvents()
 {
-    //3 = skip if equal to literal, 4 = skip if not equal to literal, 5 = skip if equal to register, 9 = skip if not equal to register
-    unsigned char x = getHex(opcode, 1, 1);
+    InputEvent event;
     
-    switch (getHex(opcode, 0, 1))
+    while (events.pop(event))
     {
-        case 0x3:
-            //printf("Skip if %x is equal %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 2));
-            if (registers[x] == getHex(opcode, 2, 2))
-                pc += 2;
-            break;
-        case 0x4:
-            //printf("Skip if %x is NOT equal to %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 2));
-            if (registers[x] != getHex(opcode, 2, 2))
-                pc += 2;
-            break;
-        case 0x5:
-            //printf("Skip if %x is equal %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 1));
-            if (registers[x] == registers[getHex(opcode, 2, 1)])
-                pc += 2;
-            break;
-        case 0x9:
-            //printf("Skip if %x is NOT equal %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 1));
-            if (registers[x] != registers[getHex(opcode, 2, 1)])
-                pc += 2;
-            break;
-        default:
-            break;
+        switch (event.type)
+        {
+            case INPUT_KEY_DOWN:
+                keys |= 1 << event.key;
+                pressedKey = event.key;
+                break;
+            case INPUT_KEY_UP:
+                keys &= ~(1 << event.key);
+                break;
+            case INPUT_REWIND_DOWN:
+                rewindHeld = true;
+                break;
+            case INPUT_REWIND_UP:
+                rewindHeld = false;
+                break;
+        }
     }
 }
 
-//Need to remove the 00 from Vx
-void Chip::hex6 (unsigned short opcode)
+bool Chip::pollEvents()
 {
-    //printf("Store %d in V%x\n", getHex(opcode, 2, 2), getHex(opcode, 1, 1));
-    registers[getHex(opcode, 1, 1)] = getHex(opcode, 2, 2);
-}
-
-void Chip::hex7 (unsigned short opcode)
-{
-    //printf("Add %d to  V%x\n", getHex(opcode, 2, 2), getHex(opcode, 1, 1));
-    registers[getHex(opcode, 1, 1)] += getHex(opcode, 2, 2);
+    //Only presses from this poll count, a key hit long before an Fx0A shouldn't answer it
+    pressedKey = -1;
+    
+    drainEvents();
+    
+    if (rewind != nullptr && !quit)
+    {
+        rewindWhileHeld();
+        //The frame about to run starts from here
+        rewind->record(core);
+    }
+    
+    return !quit;
 }
 
-void Chip::hex8 (unsigned short opcode)
+void Chip::rewindWhileHeld()
 {
-    unsigned short x = getHex(opcode, 1, 1);
-    unsigned short y = getHex(opcode, 2, 1);
+    //Back at the same speed it went forwards
+    Pacer pacer;
+    pacer.start(*this, core.getTimerRate());
     
-    switch (getHex(opcode, 3, 1))
+    while (rewindHeld && !quit)
     {
-        case 0x0:
-            //printf("Store V%x in V%x\n", getHex(opcode, 2, 1), getHex(opcode, 1, 1));
-            registers[x] = registers[y];
-            break;
-        case 0x1:
-            //printf("Set %x to %x OR %x\n", getHex(opcode, 1, 1), getHex(opcode, 1, 1), getHex(opcode, 2, 1));
-            registers[x] |= registers[y];
-            break;
-        case 0x2:
-            //printf("Set %x to %x AND %x\n", getHex(opcode, 1, 1), getHex(opcode, 1, 1), getHex(opcode, 2, 1));
-            registers[x] &= registers[y];
-            break;
-        case 0x3:
-            //printf("Set %x to %x XOR %x\n", getHex(opcode, 1, 1), getHex(opcode, 1, 1), getHex(opcode, 2, 1));
-            registers[x] ^= registers[y];
-            break;
-        case 0x4:
-        {
-            //printf("Add %x to %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 1));
-            unsigned short result = registers[x] + registers[y];
-            registers[0xf] = result > 255;
-            registers[x] = result;
-            break;
-        }
-        case 0x5:
-            //printf("Subtract %x from %x\n", getHex(opcode, 2, 1), getHex(opcode, 1, 1));
-            registers[0xf] = registers[x] > registers[y];
-            registers[x] -= registers[y];
-            break;
-        case 0x6:
-            //printf("Shift %x right 1 position and save in %x\n", getHex(opcode, 2, 1), getHex(opcode, 1, 1));
-            registers[0xf] = registers[x] & 0x1;
-            registers[x] >>= 1;
-            break;
-        case 0x7:
-            //printf("Set %x to %x minus %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 1), getHex(opcode, 1, 1));
-            registers[0xf] = registers[y] > registers[x];
-            registers[x] = registers[y] - registers[x];
-            break;
-        case 0xE:
-            //printf("Shift %x left 1 position and save in %x\n", getHex(opcode, 2, 1), getHex(opcode, 1, 1));
-            registers[0xf] = (registers[x] & 0x80) > 0;
-            registers[x] <<= 1;
-            break;
-            
-        default:
-            printf("Unhandled %x\n", opcode);
-            exit(1);
-            break;
+        if (rewind->stepBack(core))
+            core.renderDisplay();
+        
+        drainEvents();
+        //Keys hit while going back were for the rewind, not the game
+        pressedKey = -1;
+        
+        pacer.wait(*this);
     }
 }
 
-void Chip::hexA (unsigned short opcode)
+bool Chip::isKeyDown(unsigned char key)
 {
-    //printf("Store %x in I\n", getHex(opcode, 1, 3));
-    I = getHex(opcode, 1, 3);
+    return (keys >> key) & 1;
 }
 
-void Chip::hexB (unsigned short opcode)
+int Chip::getKeyPress()
 {
-    //printf("Jump to %x + v0\n", getHex(opcode, 1, 3));
-    pc = getHex(opcode, 1, 3) + registers[0];
-    jumpFlag = true;
+    int key = pressedKey;
+    pressedKey = -1;
+    
+    return key;
 }
 
-void Chip::hexC (unsigned short opcode)
+void Chip::render(const uint64_t* display, int width, int height, int planes, uint64_t dirtyRows)
 {
-    //printf("Set %x to a random number with mask %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 2));
-    registers[getHex(opcode, 1, 1)] = random() & getHex(opcode, 2, 2);
+    //Only a copy here, the window thread works out what changed since what it last showed - frames it skipped
+    //would lose their dirty rows otherwise
+    TripleBuffer::Frame& frame = frames.getBack();
+    
+    memcpy(frame.display, display, planes * width * height / 64 * sizeof(uint64_t));
+    frame.width = width;
+    frame.height = height;
+    frame.planes = planes;
+    
+    frames.publish();
 }
 
-void Chip::hexD (unsigned short opcode)
+void Chip::presentLatest()
 {
-    //printf("Draw sprite at x=%x y=%x with %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 1), getHex(opcode, 3, 1));
-    unsigned short x = registers[getHex(opcode, 1, 1)];
-    unsigned short y = registers[getHex(opcode, 2, 1)];
-    unsigned short height = getHex(opcode, 3, 1);
-    unsigned short pixel;
-    //printf("x %d y %d\n", x, y);
+    //A colour per combination of plane bits - CHIP-8 and SUPER-CHIP only ever use the first two
+    static const uint32_t palette [16] = {
+        0xFF000000, 0xFFFFFFFF, 0xFFAAAAAA, 0xFF555555, 0xFFFF0000, 0xFF00FF00, 0xFF0000FF, 0xFFFFFF00,
+        0xFF880000, 0xFF008800, 0xFF000088, 0xFF888800, 0xFFFF00FF, 0xFF00FFFF, 0xFF880088, 0xFF008888
+    };
     
-    //Set overflow register to 0
-    registers[0xF] = 0;
+    const TripleBuffer::Frame& frame = frames.getFront();
+    const uint64_t* display = frame.display;
+    int width = frame.width;
+    int height = frame.height;
+    int planes = frame.planes;
+    int rowWords = width / 64;
+    int planeWords = rowWords * height;
+    uint64_t dirtyRows = 0;
     
-    for (int yline = 0; yline < height; yline++)
+    for (int plane = 0; plane < planes; plane++)
     {
-        pixel = memory[I + yline];
-        
-        for (int xline = 0; xline < 8; xline++)
+        for (int y = 0; y < height; y++)
         {
-            if ((pixel & (0x80 >> xline)) != 0)
+            for (int i = 0; i < rowWords; i++)
             {
-                if (display[(x + xline + ((y + yline) * 64))] == 1)
-                    registers[0xF] = 1;
+                int index = plane * planeWords + y * rowWords + i;
                 
-                display[x + xline + ((y + yline) * 64)] ^= 1;
+                if (display[index] != shown[index])
+                    dirtyRows |= 1ull << y;
             }
         }
     }
     
-    drawFlag = true;
+    memcpy(shown, display, planes * planeWords * sizeof(uint64_t));
     
-}
-
-void Chip::hexE (unsigned short opcode)
-{
-    //Get whole keyboard state
-    int numKeys = 0;
-    const uint8_t* keyboardState = SDL_GetKeyboardState(&numKeys);
-    
-    unsigned short x = getHex(opcode, 1, 1);
-    //Check keyboard state for key pressed, register[x] contains key to check, look that value up against key lookup table to get SDL_Scancode
-    bool keyState = keyboardState[keyLookup[registers[x]]];
-
-    switch (getHex(opcode, 2, 2))
+    if (texture == nullptr || width != textureWidth || height != textureHeight || planes != shownPlanes)
     {
-        case 0x9E:
-            //printf("Skip if key stored in %x is pressed\n", getHex(opcode, 1, 1));
-            if (keyState)
-                pc += 2;
-            break;
-        
-        case 0xA1:
-            //printf("Skip if key stored in %x is NOT pressed \n", getHex(opcode, 1, 1));
-            if (!keyState)
-                pc += 2;
-            break;
-        default:
-            printf("Unhandled %x\n", opcode);
-            exit(1);
-            break;
+        //One texel per Chip8 pixel, the renderer scales it up to the window
+        texture = make_unique<Texture>(*renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+        pixels.assign(width * height, 0xFF000000);
+        textureWidth = width;
+        textureHeight = height;
+        shownPlanes = planes;
+        dirtyRows = ~0ull;
     }
-}
-
-void Chip::hexF (unsigned short opcode)
-{
-    //Everything acts on the bit in position 1 (0x0f00)
-    unsigned short x = getHex(opcode, 1, 1);
     
-    switch (getHex(opcode, 2, 2))
+    int firstRow = height;
+    int lastRow = -1;
+    
+    for (int y = 0; y < height; y++)
     {
-        case 0x07:
-            //printf("Store value of delay timer in %x\n", x);
-            registers[x] = dt;
-            break;
-        case 0x0A:
+        if (((dirtyRows >> y) & 1) == 0)
+            continue;
+        
+        firstRow = min(firstRow, y);
+        lastRow = y;
+        
+        const uint64_t* row = &display[y * rowWords];
+        uint32_t* out = &pixels[y * width];
+        
+        if (planes == 1)
         {
-            printf("Wait for a keypress and save in %x\n", x);
-            //Cycles are emulated in batches, this stops processing until a key is pressed, therefore not rendering the
-            //current display
-            renderDisplay();
-            
-            SDL_Event event;
-            
-            while (SDL_WaitEvent(&event))
-            {
-                if (event.type == SDL_KEYDOWN)
-                {
-                    unsigned char chipKey = lookupScancode(event.key.keysym.scancode);
-                    
-                    if (chipKey < keyLookup.size())
-                    {
-                        registers[x] = chipKey;
-                        break;
-                    }
-                }
-            }
-            
-            break;
+            //Black and white, no need to gather bits from other planes
+            for (int x = 0; x < width; x++)
+                out[x] = palette[(row[x / 64] >> (63 - (x % 64))) & 1];
         }
-        case 0x15:
-            //printf("Set delay timer to value in %x\n", x);
-            dt = registers[x];
-            break;
-        case 0x18:
-            //printf("Set sound timer to value in %x\n", x);
-            st = registers[x];
-            break;
-        case 0x1E:
-            //printf("Add value in %x to register I\n", x);
-            //Set VF for overflow
-            registers[0xF] = (I + registers[x]) > 0xFFF;
-            I += registers[x];
-            break;
-        case 0x29:
-            //printf("Set I to address of sprite data in %x\n", x);
-            I = (registers[x] * 5);
-            break;
-        case 0x33:
+        else
         {
-            //printf("Store binary coded decimal of %x in I, I+1, I+2\n", x);
-            int v = registers[x];
-            
-            for (int i = 2; i >= 0; i--)
+            for (int x = 0; x < width; x++)
             {
-                memory[I + i] = v % 10;
-                v /= 10;
+                int colour = 0;
+                
+                for (int plane = 0; plane < planes; plane++)
+                    colour |= ((row[plane * planeWords + x / 64] >> (63 - (x % 64))) & 1) << plane;
+                
+                out[x] = palette[colour];
             }
-            
-            break;
         }
-        case 0x55:
-            //printf("Store all registers v0 to v%x to memory starting at I, I becomes I + %x + 1\n", x, x);
-            for (int i = 0; i <= x; i++)
-            {
-                memory[I + i] = registers[i];
-            }
-            break;
-        case 0x65:
-            //printf("Fill registers v0 to v%x from memory starting at I, I becomes I + %x + 1\n", x, x);
-            for (int i = 0; i <= x; i++)
-            {
-                registers[i] = memory[I + i];
-            }
-            
-            break;
-        default:
-            printf("Unhandled %x\n", opcode);
-            exit(1);
-            break;
     }
     
+    if (lastRow < 0)
+        return;
+    
+    //Single upload covering every dirty row
+    texture->Update(Rect(0, firstRow, width, lastRow - firstRow + 1), &pixels[firstRow * width], width * sizeof(uint32_t));
+    
+    present();
 }
 
-
-
-size_t Chip::disassembleChip8 (unsigned char* buffer)
+void Chip::present()
 {
-    size_t opSize = 2;
-    
-    //Opcodes are 16-bit - put together buffer[0] + buffer[1]
-    unsigned short opcode = (*buffer << 8) | buffer[1];
-    printf("%04x    -    ", opcode);
-    
-    //Most opcodes are based on the first character - mask it
-    
-    switch (getHex(opcode, 0, 1))
-    {
-        case 0x0:
-            hex0(opcode);
-            break;
-        case 0x1:
-        case 0x2:
-            goToAddress(opcode);
-            break;
-        case 0x3:
-        case 0x4:
-        case 0x5:
-        case 0x9:
-            skipNextInstruction(opcode);
-            break;
-        case 0x6:
-            hex6(opcode);
-            break;
-        case 0x7:
-            hex7(opcode);
-            break;
-        case 0x8:
-            hex8(opcode);
-            break;
-        case 0xA:
-            hexA(opcode);
-            break;
-        case 0xB:
-            hexB(opcode);
-            break;
-        case 0xC:
-            hexC(opcode);
-            break;
-        case 0xD:
-            hexD(opcode);
-            break;
-        case 0xE:
-            hexE(opcode);
-            break;
-        case 0xF:
-            hexF(opcode);
-            break;
-            
-        default:
-            printf("Not implemented: %x", opcode);
-            exit(1);
-            break;
-    }
+    renderer->SetDrawColor(0, 0, 0);
+    renderer->Clear();
     
+    if (texture != nullptr)
+        renderer->Copy(*texture);
     
+    renderer->Present();
     
-    //printf("%x", opcode);
-    return opSize;
+    //Blocks until the refresh with vsync on, so coming back is as good a timestamp of it as there is
+    if (vsync)
+        lastVsync.store(getTime(), memory_order_relaxed);
 }
 
-void Chip::emulateCycle()
+uint64_t Chip::getTime()
 {
-    unsigned short opcode = (memory[pc] << 8) | memory[pc+1];
-    //printf("%x %d\n", opcode, pc);
-    
-    jumpFlag = false;
+    uint64_t counter = SDL_GetPerformanceCounter();
     
-    //Most opcodes are based on the first character - mask it
-    switch (getHex(opcode, 0, 1))
-    {
-        case 0x0:
-            hex0(opcode);
-            break;
-        case 0x1:
-        case 0x2:
-            goToAddress(opcode);
-            break;
-        case 0x3:
-        case 0x4:
-        case 0x5:
-        case 0x9:
-            skipNextInstruction(opcode);
-            break;
-        case 0x6:
-            hex6(opcode);
-            break;
-        case 0x7:
-            hex7(opcode);
-            break;
-        case 0x8:
-            hex8(opcode);
-            break;
-        case 0xA:
-            hexA(opcode);
-            break;
-        case 0xB:
-            hexB(opcode);
-            break;
-        case 0xC:
-            hexC(opcode);
-            break;
-        case 0xD:
-            hexD(opcode);
-            break;
-        case 0xE:
-            hexE(opcode);
-            break;
-        case 0xF:
-            hexF(opcode);
-            break;
-            
-        default:
-            printf("Not implemented: %x", opcode);
-            exit(1);
-            break;
-    }
-    
-    if ( !jumpFlag)
-        pc += 2;
-    
-}
\ No newline at end of file
+    //Split so the multiply can't overflow however long the machine has been up
+    return counter / counterFrequency * 1000000000ull + counter % counterFrequency * 1000000000ull / counterFrequency;
+}
+
+void Chip::sleep(uint64_t nanoseconds)
+{
+    //Only whole milliseconds, the Pacer spins out the rest
+    SDL_Delay((Uint32) (nanoseconds / 1000000));
+}
+
+long Chip::lookupScancode(SDL_Scancode code)
+{
+    return find(keyLookup.begin(), keyLookup.end(), code) - keyLookup.begin();
+}
@@ -11,107 +11,129 @@
 
 #include <stdio.h>
 #include <iostream>
-#include <fstream>
+#include <algorithm>
 #include <memory>
-#include <random>
+#include <deque>
 #include <vector>
-
-#include <assert.h>
+#include <atomic>
+#include <thread>
 
 #include <SDL2/SDL.h>
 
 #include <SDL2pp/SDL.hh>
 #include <SDL2pp/Window.hh>
 #include <SDL2pp/Renderer.hh>
+#include <SDL2pp/Texture.hh>
+#include <SDL2pp/AudioDevice.hh>
+#include <SDL2pp/AudioSpec.hh>
+#include <SDL2pp/Exception.hh>
 
-#include "chip8.h"
+#include "Beeper.h"
+#include "Core.h"
+#include "InputLog.h"
+#include "InputQueue.h"
+#include "Rewind.h"
+#include "TripleBuffer.h"
 
-class Chip
+//SDL frontend - owns the window and feeds keyboard, display and timing into a headless Core. The Core runs on its
+//own thread, so the Input, Video and Timer calls below all happen there; the thread that called emulate only
+//handles window events and presents, and the two only meet through the input queue and the triple buffer
+class Chip : public Input, public Video, public Timer
 {
 public:
-    Chip();
+    //softwareRenderer forces SDL's software renderer, for machines without a GPU. audioDriver picks SDL's audio
+    //driver ("dummy" plays nothing but still runs the device at real time), nullptr for the default one. vsync
+    //presents on the display's refresh and pulls the emulation timer into line with it
+    Chip(bool softwareRenderer = false, const char* audioDriver = nullptr, bool vsync = false);
     ~Chip();
     
     void initSDL ();
+    //Sound is optional, without a device the game just runs silent
+    void initAudio (const char* driver);
     void loadFile (char* location);
     
+    //Runs the Core on the emulation thread until it stops or the window is closed
     void emulate ();
-
-private:
-    chip8 other;
-    
-    unsigned short getHex (unsigned short opcode, uint8_t position, uint8_t length);
-    void hex0 (unsigned short opcode);
-    
-    void goToAddress (unsigned short opcode);
-    void skipNextInstruction (unsigned short opcode);
-    
-    void hex6 (unsigned short opcode);
     
-    void hex7 (unsigned short opcode);
+    Core& getCore () { return core; }
     
-    void hex8 (unsigned short opcode);
+    //Keep budget bytes of frame history, hold backspace to step back through it. 0 turns it off
+    void setRewindBudget (size_t budget);
     
-    void hexA (unsigned short opcode);
-    void hexB (unsigned short opcode);
+    //Input
+    bool pollEvents () override;
+    bool isKeyDown (unsigned char key) override;
+    int getKeyPress () override;
     
-    void hexC (unsigned short opcode);
+    //Video
+    void render (const uint64_t* display, int width, int height, int planes, uint64_t dirtyRows) override;
     
-    void hexD (unsigned short opcode);
-    void hexE (unsigned short opcode);
-    void hexF (unsigned short opcode);
-    size_t disassembleChip8 (unsigned char* buffer);
+    //Timer
+    uint64_t getTime () override;
+    void sleep (uint64_t nanoseconds) override;
+    uint64_t getLastVsync () override { return lastVsync.load(std::memory_order_relaxed); }
+
+private:
+    Core core;
     
-    unsigned char random();
     long lookupScancode (SDL_Scancode code);
-    
-    void renderDisplay ();
-    bool setPixel (int x, int y);
-    void emulateCycle ();
+    void present ();
+    
+    //Emulation thread
+    void emulationLoop ();
+    //Takes everything the window thread queued up
+    void drainEvents ();
+    //Steps back a frame at a time for as long as the rewind key is held
+    void rewindWhileHeld ();
+    
+    //Window thread
+    void handleEvent (const SDL_Event& event);
+    //Onto the input queue, or held in pendingEvents until flushEvents finds room for it
+    void queueEvent (InputEvent event);
+    void flushEvents ();
+    //Converts the newest frame from the emulation thread into the texture and shows it
+    void presentLatest ();
     
     ////////////////////////
     //      Variables     //
     ////////////////////////
-    bool fileLoaded;
-    
-    //4k
-    unsigned char memory [0xfff];
-    //0x0 - 0x200 is used for the intepreter, so actual memory starts at 0x200
-    const int memoryStart;
-    const size_t memorySize;
-    
-    //General registers - VF is a special flag
-    unsigned char registers [16];
-    //Special register used to store memory addresses
-    unsigned short I;
-    
-    //Program counter - currently executing address
-    unsigned short pc;
-    bool jumpFlag;
-    //Stack pointer - Topmost level of the stack
-    unsigned char sp;
-    //Stack - used to store return address when leaving subroutines
-    unsigned short stack [16];
-    
-    //Sound and delay - decrement at a rate of 60hz
-    //Sound timer - sounds as long as the value is greater than 0 - single tone, frequency = whatever
-    unsigned char st;
-    //Delay timer - just decrements
-    unsigned char dt;
-    
-    //Display
-    int displayWidth;
-    int displayHeight;
     int pixelSize;
-    unsigned char display [64*32];
-    bool drawFlag;
-    
-    int fps;
-    int frameRate;
-    
-    //Random numbers
-    std::default_random_engine generator;
-    std::uniform_int_distribution<unsigned char> distribution;
+    bool software;
+    bool vsync;
+    //SDL_GetPerformanceCounter ticks a second
+    uint64_t counterFrequency;
+    //getTime when a vsynced Present last came back
+    std::atomic<uint64_t> lastVsync;
+    
+    //Set by the window thread to stop the emulation thread
+    std::atomic<bool> quit;
+    //Cleared by the emulation thread once it's finished
+    std::atomic<bool> running;
+    
+    InputQueue events;
+    //Window thread's events that didn't fit in the queue yet, oldest first
+    std::deque<InputEvent> pendingEvents;
+    TripleBuffer frames;
+    
+    //Emulation thread's view of the keyboard, built from events
+    uint16_t keys;
+    bool rewindHeld;
+    //Latest Chip8 key pressed during the last pollEvents, -1 for none
+    int pressedKey;
+    
+    //What's in the texture, to work out which rows the next frame changes
+    uint64_t shown [TripleBuffer::maxDisplayWords];
+    int shownPlanes;
+    
+    //Framebuffer as texture pixels, only the dirty rows are converted and uploaded
+    std::vector<uint32_t> pixels;
+    int textureWidth;
+    int textureHeight;
+    
+    std::unique_ptr<Rewind> rewind;
+    
+    //Filled by the Core on this thread, emptied by the audio callback on SDL's
+    std::unique_ptr<Beeper> beeper;
     
     //Keyboard events
     std::vector<SDL_Scancode> keyLookup;
@@ -120,6 +142,9 @@ private:
     std::unique_ptr<SDL2pp::SDL> sdl;
     std::unique_ptr<SDL2pp::Window> window;
     std::unique_ptr<SDL2pp::Renderer> renderer;
+    std::unique_ptr<SDL2pp::Texture> texture;
+    //After beeper so it's closed, and the callback stopped, before the beeper goes
+    std::unique_ptr<SDL2pp::AudioDevice> audioDevice;
 };
 
 #endif /* defined(__Chip8__Chip__) */
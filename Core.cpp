@@ -0,0 +1,1496 @@
+//
+//  Core.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Core.h"
+#include "Font.h"
+#include "Hash.h"
+#include "Recompiler.h"
+#include "Rom.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+using namespace std;
+
+//Must be in the same order as Op
+template <unsigned Q>
+const Core::Handler Core::handlerTable [OP_COUNT] = {
+    &Core::opSys, &Core::opCls, &Core::opRet, &Core::opJp, &Core::opCall,
+    &Core::opSeByte, &Core::opSneByte, &Core::opSeReg, &Core::opLdByte, &Core::opAddByte,
+    &Core::opLdReg, &Core::opOr<Q>, &Core::opAnd<Q>, &Core::opXor<Q>, &Core::opAddReg,
+    &Core::opSub, &Core::opShr<Q>, &Core::opSubn, &Core::opShl<Q>, &Core::opSneReg,
+    &Core::opLdI, &Core::opJpV0<Q>, &Core::opRnd, &Core::opDrw<Q>, &Core::opSkp, &Core::opSknp,
+    &Core::opLdVxDt, &Core::opLdVxK, &Core::opLdDt, &Core::opLdSt, &Core::opAddI,
+    &Core::opLdF, &Core::opLdB, &Core::opLdMem<Q>, &Core::opLdRegs<Q>,
+    &Core::opScd, &Core::opScr, &Core::opScl, &Core::opExit, &Core::opLow, &Core::opHigh,
+    &Core::opLdHf, &Core::opSaveFlags, &Core::opLoadFlags,
+    &Core::opScu, &Core::opSaveRange, &Core::opLoadRange, &Core::opLdILong, &Core::opPlane, &Core::opAudio, &Core::opPitch,
+    &Core::opUnhandled
+};
+
+//F(0) to F(quirkCombinations - 1), one for every combination of quirks
+#define QUIRK_VARIANTS(F) \
+    F(0), F(1), F(2), F(3), F(4), F(5), F(6), F(7), F(8), F(9), F(10), F(11), F(12), F(13), F(14), F(15), \
+    F(16), F(17), F(18), F(19), F(20), F(21), F(22), F(23), F(24), F(25), F(26), F(27), F(28), F(29), F(30), F(31)
+
+static_assert(quirkCombinations == 32, "QUIRK_VARIANTS has to cover every combination");
+
+#define HANDLER_TABLE(Q) Core::handlerTable<Q>
+#define THREADED_LOOP(Q) &Core::emulateCyclesThreaded<Q>
+
+const Core::Handler* const Core::handlerTables [quirkCombinations] = { QUIRK_VARIANTS(HANDLER_TABLE) };
+const Core::Loop Core::threadedLoops [quirkCombinations] = { QUIRK_VARIANTS(THREADED_LOOP) };
+
+#undef HANDLER_TABLE
+#undef THREADED_LOOP
+
+Core::Core () : input(nullptr), video(nullptr), timer(nullptr), audio(nullptr), profiler(nullptr), memoryStart(0x200), memorySize(0x1000)
+{
+    seed(0);
+    
+    //Rates in Hz - instructions and timer ticks are in emulated time, presentation in wall time when in turbo
+    instructionRate = 540;
+    timerRate = 60;
+    presentRate = 60;
+    turbo = false;
+    dispatch = DISPATCH_TABLE;
+    idleSkip = true;
+    
+    setMode(MODE_CHIP8);
+}
+
+Core::~Core()
+{
+    
+}
+
+void Core::setMode(Mode newMode)
+{
+    mode = newMode;
+    decodeTable = getDecodeTable(mode);
+    
+    memorySize = mode == MODE_XOCHIP ? 0x10000 : 0x1000;
+    addressMask = memorySize - 1;
+    
+    setQuirks(getDefaultQuirks(mode));
+    reset();
+}
+
+void Core::setQuirks(uint8_t newQuirks)
+{
+    quirks = newQuirks & (quirkCombinations - 1);
+    handlers = handlerTables[quirks];
+    threadedLoop = threadedLoops[quirks];
+    
+    //Compiled blocks point at the old handlers
+    if (recompiler != nullptr)
+        recompiler->flush();
+}
+
+void Core::reset()
+{
+    memset(memory, 0, sizeof(memory));
+    memset(registers, 0, sizeof(registers));
+    memset(stack, 0, sizeof(stack));
+    memset(display, 0, sizeof(display));
+    memset(flags, 0, sizeof(flags));
+    
+    //Every mode starts in 64x32
+    displayWidth = 64;
+    displayHeight = 32;
+    planeMask = 1;
+    
+    //First present always goes up
+    dirtyRows = ~0ull;
+    
+    //XO-CHIP's default tone, until F002 loads another
+    memset(pattern, 0xF0, sizeof(pattern));
+    pitch = 64;
+    
+    if (audio != nullptr)
+    {
+        audio->setPattern(pattern);
+        audio->setPitch(pitch);
+    }
+    
+    I = 0;
+    pc = memoryStart;
+    sp = 0;
+    
+    st = 0;
+    dt = 0;
+    
+    fps = 0;
+    cycles = 0;
+    instructionCredit = 0;
+    
+    status = STATUS_RUNNING;
+    unhandledOpcode = 0;
+    
+    waitingForKey = false;
+    keyRegister = 0;
+    
+    frameStartCycles = 0;
+    frameCycles = 0;
+    pendingCycles = 0;
+    soundEdgeCount = 0;
+    
+    if (recompiler != nullptr)
+        recompiler->flush();
+    
+    //Read sprite data into interpreter memory (0x0 - 0x200)
+    //Sprites start at position 0 and are 5 bytes each
+    memcpy(memory, smallFont, sizeof(smallFont));
+    
+    //Plain CHIP-8 programs can have anything they like at 0x50, only the later modes have the big font there
+    if (mode != MODE_CHIP8)
+        memcpy(&memory[bigFontStart], bigFont, sizeof(bigFont));
+    
+    fileLoaded = false;
+    romHash = 0;
+    romSize = 0;
+}
+
+bool Core::loadFile(const char *location)
+{
+    MappedROM rom(location, memorySize - memoryStart);
+    
+    if (rom.getData() == nullptr)
+        return false;
+    
+    return loadROM(rom.getData(), rom.getSize());
+}
+
+bool Core::loadROM(const unsigned char *data, size_t size)
+{
+    if (size > memorySize - memoryStart)
+    {
+        cerr << "ROM too large " << size << " bytes" << endl;
+        return false;
+    }
+    
+    memcpy(&memory[memoryStart], data, size);
+    romHash = hashROM(data, size);
+    romSize = size;
+    
+    if (recompiler != nullptr)
+        recompiler->flush();
+    
+    fileLoaded = true;
+    
+    return true;
+}
+
+void Core::saveState(Snapshot& snapshot) const
+{
+    size_t displaySize = getDisplayBytes();
+    
+    //Zeroed first so padding and whatever the mode doesn't use don't turn up in deltas. The active display and
+    //memory are written over straight after, no need to clear them
+    memset(&snapshot, 0, offsetof(Snapshot, display));
+    memset((uint8_t*) snapshot.display + displaySize, 0, sizeof(snapshot.display) - displaySize);
+    memset(snapshot.memory + memorySize, 0, sizeof(snapshot.memory) - memorySize);
+    
+    snapshot.magic = Snapshot::magicValue;
+    snapshot.version = Snapshot::currentVersion;
+    snapshot.size = sizeof(Snapshot);
+    snapshot.randomState = randomState;
+    snapshot.memorySize = (uint32_t) memorySize;
+    snapshot.displaySize = (uint32_t) displaySize;
+    
+    memcpy(snapshot.memory, memory, memorySize);
+    memcpy(snapshot.registers, registers, sizeof(registers));
+    memcpy(snapshot.stack, stack, sizeof(stack));
+    snapshot.I = I;
+    snapshot.pc = pc;
+    snapshot.sp = sp;
+    snapshot.dt = dt;
+    snapshot.st = st;
+    snapshot.status = status;
+    snapshot.unhandledOpcode = unhandledOpcode;
+    snapshot.waitingForKey = waitingForKey;
+    snapshot.keyRegister = keyRegister;
+    
+    snapshot.mode = mode;
+    snapshot.hires = displayWidth == maxDisplayWidth;
+    snapshot.planeMask = planeMask;
+    snapshot.pitch = pitch;
+    snapshot.quirks = quirks;
+    memcpy(snapshot.flags, flags, sizeof(flags));
+    memcpy(snapshot.pattern, pattern, sizeof(pattern));
+    
+    static_assert(sizeof(snapshot.display) == sizeof(display) && sizeof(snapshot.memory) == sizeof(memory), "Snapshot doesn't fit the Core");
+    memcpy(snapshot.display, display, displaySize);
+    snapshot.cycles = cycles;
+    snapshot.instructionCredit = instructionCredit;
+}
+
+bool Core::loadState(const Snapshot& snapshot)
+{
+    if (!snapshot.isValid() || snapshot.mode >= MODE_COUNT)
+        return false;
+    
+    //Only the machine it was taken on has the right decode table and memory size
+    if (snapshot.mode != mode)
+        setMode((Mode) snapshot.mode);
+    
+    //After setMode, which goes back to the mode's defaults
+    if (snapshot.quirks != quirks)
+        setQuirks(snapshot.quirks);
+    
+    memcpy(memory, snapshot.memory, memorySize);
+    memcpy(registers, snapshot.registers, sizeof(registers));
+    memcpy(stack, snapshot.stack, sizeof(stack));
+    I = snapshot.I;
+    pc = snapshot.pc;
+    sp = snapshot.sp;
+    dt = snapshot.dt;
+    st = snapshot.st;
+    status = (Status) snapshot.status;
+    unhandledOpcode = snapshot.unhandledOpcode;
+    waitingForKey = snapshot.waitingForKey != 0;
+    keyRegister = snapshot.keyRegister & 0xF;
+    
+    displayWidth = snapshot.hires ? maxDisplayWidth : 64;
+    displayHeight = snapshot.hires ? maxDisplayHeight : 32;
+    planeMask = snapshot.planeMask & ((1 << maxPlanes) - 1);
+    pitch = snapshot.pitch;
+    memcpy(flags, snapshot.flags, sizeof(flags));
+    memcpy(pattern, snapshot.pattern, sizeof(pattern));
+    
+    if (audio != nullptr)
+    {
+        audio->setPattern(pattern);
+        audio->setPitch(pitch);
+    }
+    
+    memcpy(display, snapshot.display, sizeof(display));
+    cycles = snapshot.cycles;
+    instructionCredit = snapshot.instructionCredit;
+    randomState = snapshot.randomState;
+    
+    //Whole new display and all new code
+    dirtyRows = ~0ull;
+    
+    if (recompiler != nullptr)
+        recompiler->flush();
+    
+    fileLoaded = true;
+    
+    return true;
+}
+
+long Core::run(long frames)
+{
+    if (!fileLoaded)
+    {
+        cerr << "A game file must be loaded before emulation" << endl;
+        exit(1);
+    }
+    
+    uint64_t secondCounter = 0;
+    uint64_t lastPresent = timer != nullptr ? timer->getTime() : 0;
+    //Counted in 1/timerRate steps so presentRate doesn't have to divide timerRate
+    long presentCredit = 0;
+    
+    if (timer != nullptr)
+        pacer.start(*timer, timerRate);
+    
+    long frame;
+    
+    for (frame = 0; frames < 0 || frame < frames; frame++)
+    {
+        if (status != STATUS_RUNNING)
+            break;
+        
+        //Get time
+        uint64_t blockStartTime = timer != nullptr ? timer->getTime() : 0;
+        
+        if (timer != nullptr)
+        {
+            if (secondCounter == 0)
+                secondCounter = blockStartTime;
+            else if (secondCounter + 1000000000 < blockStartTime)
+            {
+                //printf("FPS: %d\n", fps);
+                fps = 0;
+                secondCounter = blockStartTime;
+            }
+        }
+        
+        //Nothing to hurry while Fx0A is waiting, go back to real time and check the keys every frame
+        bool fast = turbo && !waitingForKey;
+        bool present;
+        
+        if (fast && timer != nullptr)
+        {
+            //Emulated time is running as fast as it can, only show a frame every so often in real time
+            present = presentRate > 0 && blockStartTime - lastPresent >= 1000000000ull / presentRate;
+            
+            if (present)
+                lastPresent = blockStartTime;
+        }
+        else
+        {
+            presentCredit += presentRate;
+            present = presentCredit >= timerRate;
+            
+            if (present)
+                presentCredit %= timerRate;
+        }
+        
+        // Process input - in turbo only when there's a frame going up, polling is far slower than a timer tick
+        if ((present || !fast) && input != nullptr && !input->pollEvents())
+            break;
+        
+        emulateFrame();
+        
+        if (present)
+        {
+            renderDisplay();
+            fps++;
+        }
+        
+        //No timer or turbo - run as fast as the host can
+        if (timer == nullptr || fast)
+            continue;
+        
+        //Keeps a steady timer rate, coming back from turbo it'll be too far behind and start again from now
+        pacer.wait(*timer);
+    }
+    
+    return frame;
+}
+
+void Core::emulateFrame()
+{
+    bool soundOn;
+    int count = startFrame(soundOn);
+    
+    if (count > 0)
+    {
+        //Loops waiting on the delay timer or a key can't see anything change until the next frame
+        if (idleSkip && count > 2 * maxIdleLoop)
+            count = skipIdleLoop(count);
+        
+        emulateCycles(count);
+    }
+    
+    finishFrame(soundOn);
+}
+
+int Core::startFrame(bool& soundOn)
+{
+    //instructionRate doesn't have to be a multiple of timerRate, carry the remainder into the next tick
+    instructionCredit += instructionRate;
+    int count = (int) (instructionCredit / timerRate);
+    instructionCredit -= (long) count * timerRate;
+    
+#ifdef CHIP8_PROFILE
+    if (profiler != nullptr)
+        profiler->frameEmulated();
+#endif
+    
+    //Counted from here so Fx18 knows how far through the frame it is
+    frameStartCycles = cycles;
+    frameCycles = count;
+    soundEdgeCount = 0;
+    soundOn = st > 0;
+    
+    if (waitingForKey)
+    {
+        int key = input != nullptr ? input->getKeyPress() : -1;
+        
+        if (key >= 0)
+        {
+            //Finish the Fx0A that's been waiting
+            registers[keyRegister] = key & 0xF;
+            pc += 2;
+            waitingForKey = false;
+        }
+    }
+    
+    if (waitingForKey)
+    {
+        //Still waiting - the CPU is stopped, only the timers move. With no Input no key is ever coming, once the
+        //sound timer has run out there's nothing left to happen
+        if (idleSkip && input == nullptr && st == 0)
+            status = STATUS_HALTED;
+        
+        return 0;
+    }
+    
+    return count;
+}
+
+void Core::finishFrame(bool soundOn)
+{
+    if (audio != nullptr)
+        audio->tick(soundOn, soundEdges, soundEdgeCount);
+    
+    updateTimers();
+}
+
+//Ops an idle loop can be made of - nothing that writes memory, the display, the stack, the timers or the
+//random state, so where one trip round the loop ends up is all in the registers, I and pc
+static bool isIdleOp(Op op)
+{
+    switch (op)
+    {
+        case OP_JP:
+        case OP_JP_V0:
+        case OP_SE_BYTE:
+        case OP_SNE_BYTE:
+        case OP_SE_REG:
+        case OP_SNE_REG:
+        case OP_LD_BYTE:
+        case OP_ADD_BYTE:
+        case OP_LD_REG:
+        case OP_OR:
+        case OP_AND:
+        case OP_XOR:
+        case OP_ADD_REG:
+        case OP_SUB:
+        case OP_SHR:
+        case OP_SUBN:
+        case OP_SHL:
+        case OP_LD_I:
+        case OP_ADD_I:
+        case OP_LD_F:
+        case OP_LD_REGS:
+        case OP_LD_VX_DT:
+        case OP_SKP:
+        case OP_SKNP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int Core::skipIdleLoop(int count)
+{
+    //Go round whatever loop pc is in twice. The delay timer and the keys can't change until the frame ends, so
+    //if the second trip leaves everything exactly as the first one did, so will every trip after it
+    unsigned short start = pc;
+    unsigned char tripRegisters [16];
+    unsigned short tripI = 0;
+    int tripStart = 0;
+    int steps = 0;
+    bool readsTimer = false;
+    bool readsKeys = false;
+    
+    for (int trip = 0; trip < 2; trip++)
+    {
+        if (trip == 1)
+        {
+            memcpy(tripRegisters, registers, sizeof(registers));
+            tripI = I;
+            tripStart = steps;
+        }
+        
+        do
+        {
+            if (steps >= 2 * maxIdleLoop || status != STATUS_RUNNING)
+                return count - steps;
+            
+            const Instruction& instruction = decodeTable[(memory[pc & addressMask] << 8) | memory[(pc + 1) & addressMask]];
+            
+            if (!isIdleOp(instruction.op))
+                return count - steps;
+            
+            readsTimer |= instruction.op == OP_LD_VX_DT;
+            readsKeys |= instruction.op == OP_SKP || instruction.op == OP_SKNP;
+            
+            emulateCycle();
+            steps++;
+        }
+        while (pc != start);
+    }
+    
+    if (memcmp(tripRegisters, registers, sizeof(registers)) != 0 || tripI != I)
+        return count - steps;
+    
+    //The rest of the frame is the same trip over and over, only the part of a trip left at the end has to run
+    int length = steps - tripStart;
+    int remaining = count - steps;
+    int skipped = remaining - remaining % length;
+    
+    cycles += skipped;
+    
+#ifdef CHIP8_PROFILE
+    if (profiler != nullptr)
+        profiler->idleSkipped(skipped);
+#endif
+    
+    //Waiting on a timer that has run out, or on keys from no keyboard - nothing will ever change. A beep that's
+    //still going gets to finish first, halted frames don't tick the timers
+    if ((!readsTimer || dt == 0) && (!readsKeys || input == nullptr) && st == 0)
+        status = STATUS_HALTED;
+    
+    return remaining - skipped;
+}
+
+void Core::updateTimers()
+{
+    if (dt > 0)
+        dt--;
+    
+    if (st > 0)
+        st--;
+}
+
+void Core::renderDisplay()
+{
+    //Nothing drawn since the last present - nothing to do
+    if (dirtyRows == 0 || video == nullptr)
+        return;
+    
+#ifdef CHIP8_PROFILE
+    uint64_t start = profiler != nullptr ? Profiler::now() : 0;
+#endif
+    
+    video->render(display, displayWidth, displayHeight, getDisplayPlanes(), dirtyRows);
+    dirtyRows = 0;
+    
+#ifdef CHIP8_PROFILE
+    if (profiler != nullptr)
+    {
+        profiler->addRenderTime(Profiler::now() - start);
+        profiler->frameRendered();
+    }
+#endif
+}
+
+uint64_t Core::hashDisplay() const
+{
+    //Only what the mode can show, so a plain CHIP-8 hash is the same as it always was
+    return fnv1a(display, getDisplayBytes());
+}
+
+void Core::seed(uint32_t value)
+{
+    //xorshift can't start from 0
+    randomState = value != 0 ? value : 0x9E3779B9;
+}
+
+unsigned char Core::random()
+{
+    //xorshift32 - small enough to snapshot and to run across many lanes at once in Lockstep
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    
+    return randomState >> 24;
+}
+
+void Core::opSys (const Instruction& instruction)
+{
+    //printf("Execute machine subroutine %x\n", instruction.nnn);
+}
+
+void Core::opCls (const Instruction& instruction)
+{
+    //printf("Clear the display\n");
+    int planeWords = displayHeight * displayWidth / 64;
+    
+    //Only the selected planes on XO-CHIP, planeMask is always 1 otherwise
+    for (int plane = 0; plane < maxPlanes; plane++)
+    {
+        if (planeMask & (1 << plane))
+            memset(&display[plane * planeWords], 0, planeWords * sizeof(uint64_t));
+    }
+    
+    dirtyRows = ~0ull;
+}
+
+void Core::opRet (const Instruction& instruction)
+{
+    //printf("Return from subroutine\n");
+    pc = stack[--sp & 0xF];
+}
+
+void Core::opJp (const Instruction& instruction)
+{
+    //printf("Jump to %3x\n", instruction.nnn);
+    //if (instruction.nnn < memoryStart)
+    //    printf("Accessing interpreter memory space\n");
+    
+    //Jump to itself is how most programs stop - nothing else can ever happen. Halting is part of idle skipping,
+    //and waits for the sound timer to run out so the last beep isn't cut off
+    if (idleSkip && st == 0 && instruction.nnn == ((pc - 2) & addressMask))
+        status = STATUS_HALTED;
+    
+    pc = instruction.nnn;
+}
+
+void Core::opCall (const Instruction& instruction)
+{
+    //printf("Execute subroutine at %3x\n", instruction.nnn);
+    //Save return address to stack
+    stack[sp++ & 0xF] = pc;
+    
+    //Not through opJp - a call to itself pushes the stack every time round, that's not a halt
+    pc = instruction.nnn;
+}
+
+template <unsigned Q>
+void Core::opJpV0 (const Instruction& instruction)
+{
+    //printf("Jump to %x + v0\n", instruction.nnn);
+    //SUPER-CHIP read it as BXNN, the register is the top nibble of the address
+    pc = instruction.nnn + registers[(Q & QUIRK_JUMP_VX) ? instruction.x : 0];
+}
+
+void Core::opSeByte (const Instruction& instruction)
+{
+    //printf("Skip if %x is equal %x\n", instruction.x, instruction.nn);
+    if (registers[instruction.x] == instruction.nn)
+        skip();
+}
+
+void Core::opSneByte (const Instruction& instruction)
+{
+    //printf("Skip if %x is NOT equal to %x\n", instruction.x, instruction.nn);
+    if (registers[instruction.x] != instruction.nn)
+        skip();
+}
+
+void Core::opSeReg (const Instruction& instruction)
+{
+    //printf("Skip if %x is equal %x\n", instruction.x, instruction.y);
+    if (registers[instruction.x] == registers[instruction.y])
+        skip();
+}
+
+void Core::opSneReg (const Instruction& instruction)
+{
+    //printf("Skip if %x is NOT equal %x\n", instruction.x, instruction.y);
+    if (registers[instruction.x] != registers[instruction.y])
+        skip();
+}
+
+void Core::opLdByte (const Instruction& instruction)
+{
+    //printf("Store %d in V%x\n", instruction.nn, instruction.x);
+    registers[instruction.x] = instruction.nn;
+}
+
+void Core::opAddByte (const Instruction& instruction)
+{
+    //printf("Add %d to  V%x\n", instruction.nn, instruction.x);
+    registers[instruction.x] += instruction.nn;
+}
+
+void Core::opLdReg (const Instruction& instruction)
+{
+    //printf("Store V%x in V%x\n", instruction.y, instruction.x);
+    registers[instruction.x] = registers[instruction.y];
+}
+
+template <unsigned Q>
+void Core::opOr (const Instruction& instruction)
+{
+    //printf("Set %x to %x OR %x\n", instruction.x, instruction.x, instruction.y);
+    registers[instruction.x] |= registers[instruction.y];
+    
+    //The COSMAC VIP ran these through a routine that left VF cleared
+    if (Q & QUIRK_VF_RESET)
+        registers[0xf] = 0;
+}
+
+template <unsigned Q>
+void Core::opAnd (const Instruction& instruction)
+{
+    //printf("Set %x to %x AND %x\n", instruction.x, instruction.x, instruction.y);
+    registers[instruction.x] &= registers[instruction.y];
+    
+    if (Q & QUIRK_VF_RESET)
+        registers[0xf] = 0;
+}
+
+template <unsigned Q>
+void Core::opXor (const Instruction& instruction)
+{
+    //printf("Set %x to %x XOR %x\n", instruction.x, instruction.x, instruction.y);
+    registers[instruction.x] ^= registers[instruction.y];
+    
+    if (Q & QUIRK_VF_RESET)
+        registers[0xf] = 0;
+}
+
+void Core::opAddReg (const Instruction& instruction)
+{
+    //printf("Add %x to %x\n", instruction.x, instruction.y);
+    unsigned short result = registers[instruction.x] + registers[instruction.y];
+    registers[0xf] = result > 255;
+    registers[instruction.x] = result;
+}
+
+void Core::opSub (const Instruction& instruction)
+{
+    //printf("Subtract %x from %x\n", instruction.y, instruction.x);
+    registers[0xf] = registers[instruction.x] > registers[instruction.y];
+    registers[instruction.x] -= registers[instruction.y];
+}
+
+template <unsigned Q>
+void Core::opShr (const Instruction& instruction)
+{
+    //printf("Shift %x right 1 position and save in %x\n", instruction.y, instruction.x);
+    //The COSMAC VIP shifted VY, most later interpreters shift VX in place
+    int source = (Q & QUIRK_SHIFT_VY) ? instruction.y : instruction.x;
+    registers[0xf] = registers[source] & 0x1;
+    registers[instruction.x] = registers[source] >> 1;
+}
+
+void Core::opSubn (const Instruction& instruction)
+{
+    //printf("Set %x to %x minus %x\n", instruction.x, instruction.y, instruction.x);
+    registers[0xf] = registers[instruction.y] > registers[instruction.x];
+    registers[instruction.x] = registers[instruction.y] - registers[instruction.x];
+}
+
+template <unsigned Q>
+void Core::opShl (const Instruction& instruction)
+{
+    //printf("Shift %x left 1 position and save in %x\n", instruction.y, instruction.x);
+    int source = (Q & QUIRK_SHIFT_VY) ? instruction.y : instruction.x;
+    registers[0xf] = (registers[source] & 0x80) > 0;
+    registers[instruction.x] = registers[source] << 1;
+}
+
+void Core::opLdI (const Instruction& instruction)
+{
+    //printf("Store %x in I\n", instruction.nnn);
+    I = instruction.nnn;
+}
+
+void Core::opRnd (const Instruction& instruction)
+{
+    //printf("Set %x to a random number with mask %x\n", instruction.x, instruction.nn);
+    registers[instruction.x] = random() & instruction.nn;
+}
+
+template <unsigned Q>
+void Core::opDrw (const Instruction& instruction)
+{
+    //printf("Draw sprite at x=%x y=%x with %x\n", instruction.x, instruction.y, instruction.n);
+    if (mode != MODE_CHIP8)
+    {
+        drawExtended<Q>(instruction);
+        return;
+    }
+    
+    //Start position wraps, and so does anything drawn off the edge unless it's clipped
+    //Both sizes are powers of two
+    unsigned int x = registers[instruction.x] & (displayWidth - 1);
+    unsigned int y = registers[instruction.y] & (displayHeight - 1);
+    uint64_t collision = 0;
+    
+    for (int yline = 0; yline < instruction.n; yline++)
+    {
+        unsigned int rowIndex = y + yline;
+        
+        if (Q & QUIRK_CLIP)
+        {
+            if (rowIndex >= (unsigned int) displayHeight)
+                break;
+        }
+        else
+            rowIndex &= displayHeight - 1;
+        
+        //Sprite byte lined up with x = 0 then rotated into place, the rotate does the horizontal wrap. Clipped it's
+        //only shifted, so whatever goes off the right is gone
+        uint64_t sprite = (uint64_t) memory[(I + yline) & addressMask] << 56;
+        sprite = (Q & QUIRK_CLIP) ? sprite >> x : (sprite >> x) | (sprite << ((64 - x) & 63));
+        
+        uint64_t& row = display[rowIndex];
+        collision |= row & sprite;
+        row ^= sprite;
+        
+        dirtyRows |= 1ull << rowIndex;
+    }
+    
+    //Overflow register set if anything was erased
+    registers[0xF] = collision != 0;
+}
+
+template <unsigned Q>
+void Core::drawExtended (const Instruction& instruction)
+{
+    int rowWords = displayWidth / 64;
+    int planeWords = displayHeight * rowWords;
+    //XO-CHIP wraps like CHIP-8, SUPER-CHIP cuts the sprite off at the edges
+    const bool wrap = (Q & QUIRK_CLIP) == 0;
+    
+    unsigned int x = registers[instruction.x] & (displayWidth - 1);
+    unsigned int y = registers[instruction.y] & (displayHeight - 1);
+    //DXY0 is 16x16, two bytes a row
+    int width = instruction.n != 0 ? 8 : 16;
+    int height = instruction.n != 0 ? instruction.n : 16;
+    int spriteBytes = height * width / 8;
+    
+    //A row of the sprite covers part of the word x is in and maybe the start of the next one
+    int word = x / 64;
+    int shift = x % 64;
+    int nextWord = word + 1 < rowWords ? word + 1 : (wrap ? 0 : -1);
+    
+    unsigned short address = I;
+    int collidingRows = 0;
+    
+    for (int plane = 0; plane < maxPlanes; plane++)
+    {
+        if ((planeMask & (1 << plane)) == 0)
+            continue;
+        
+        uint64_t* bits = &display[plane * planeWords];
+        
+        for (int yline = 0; yline < height; yline++)
+        {
+            unsigned int rowIndex = y + yline;
+            
+            if (rowIndex >= (unsigned int) displayHeight)
+            {
+                if (!wrap)
+                    break;
+                
+                rowIndex -= displayHeight;
+            }
+            
+            uint64_t sprite;
+            
+            if (width == 16)
+                sprite = (uint64_t) ((memory[(address + yline * 2) & addressMask] << 8) | memory[(address + yline * 2 + 1) & addressMask]) << 48;
+            else
+                sprite = (uint64_t) memory[(address + yline) & addressMask] << 56;
+            
+            uint64_t* row = &bits[rowIndex * rowWords];
+            uint64_t first = sprite >> shift;
+            uint64_t second = shift != 0 && nextWord >= 0 ? sprite << (64 - shift) : 0;
+            
+            uint64_t collision = row[word] & first;
+            row[word] ^= first;
+            
+            if (second != 0)
+            {
+                collision |= row[nextWord] & second;
+                row[nextWord] ^= second;
+            }
+            
+            if (collision != 0)
+                collidingRows++;
+            
+            dirtyRows |= 1ull << rowIndex;
+        }
+        
+        //Each selected plane takes the next sprite's worth of data
+        address += spriteBytes;
+    }
+    
+    //SUPER-CHIP in 128x64 counts the rows that hit something. Clipped rows broke out of the loop above before
+    //they were drawn, so only rows actually on the display are in it
+    if (mode == MODE_SCHIP && displayHeight == maxDisplayHeight)
+        registers[0xF] = collidingRows;
+    else
+        registers[0xF] = collidingRows != 0;
+}
+
+void Core::opSkp (const Instruction& instruction)
+{
+    //printf("Skip if key stored in %x is pressed\n", instruction.x);
+    //register[x] contains the Chip8 key to check, with no input attached nothing is ever pressed
+    if (input != nullptr && input->isKeyDown(registers[instruction.x] & 0xF))
+        skip();
+}
+
+void Core::opSknp (const Instruction& instruction)
+{
+    //printf("Skip if key stored in %x is NOT pressed \n", instruction.x);
+    if (input == nullptr || !input->isKeyDown(registers[instruction.x] & 0xF))
+        skip();
+}
+
+void Core::opLdVxDt (const Instruction& instruction)
+{
+    //printf("Store value of delay timer in %x\n", instruction.x);
+    registers[instruction.x] = dt;
+}
+
+void Core::opLdVxK (const Instruction& instruction)
+{
+    //printf("Wait for a keypress and save in %x\n", instruction.x);
+    int key = input != nullptr ? input->getKeyPress() : -1;
+    
+    if (key >= 0)
+    {
+        registers[instruction.x] = key & 0xF;
+        waitingForKey = false;
+        return;
+    }
+    
+    //No key - stay on this instruction. Every dispatch loop stops as soon as it sees the wait, and startFrame runs
+    //nothing more until a key comes in
+    waitingForKey = true;
+    keyRegister = instruction.x;
+    pc -= 2;
+}
+
+void Core::opLdDt (const Instruction& instruction)
+{
+    //printf("Set delay timer to value in %x\n", instruction.x);
+    dt = registers[instruction.x];
+}
+
+void Core::opLdSt (const Instruction& instruction)
+{
+    //printf("Set sound timer to value in %x\n", instruction.x);
+    bool wasOn = st > 0;
+    st = registers[instruction.x];
+    
+    //Where in the frame the tone starts or stops, so the audio side can place it to the sample
+    if ((st > 0) != wasOn && soundEdgeCount < maxSoundEdges && frameCycles > 0)
+    {
+        uint64_t position = cycles - pendingCycles - frameStartCycles;
+        soundEdges[soundEdgeCount++] = min((float) position / frameCycles, 1.0f);
+    }
+    
+    pendingCycles = 0;
+}
+
+void Core::opAddI (const Instruction& instruction)
+{
+    //printf("Add value in %x to register I\n", instruction.x);
+    //Set VF for overflow
+    registers[0xF] = (I + registers[instruction.x]) > addressMask;
+    I += registers[instruction.x];
+}
+
+void Core::opLdF (const Instruction& instruction)
+{
+    //printf("Set I to address of sprite data in %x\n", instruction.x);
+    I = (registers[instruction.x] * 5);
+}
+
+void Core::opLdB (const Instruction& instruction)
+{
+    //printf("Store binary coded decimal of %x in I, I+1, I+2\n", instruction.x);
+    int v = registers[instruction.x];
+    //Local so it isn't read again after every byte written
+    unsigned short mask = addressMask;
+    
+    for (int i = 2; i >= 0; i--)
+    {
+        memory[(I + i) & mask] = v % 10;
+        v /= 10;
+    }
+    
+    if (recompiler != nullptr)
+        recompiler->invalidate(I, 3);
+}
+
+template <unsigned Q>
+void Core::opLdMem (const Instruction& instruction)
+{
+    //printf("Store all registers v0 to v%x to memory starting at I, I becomes I + %x + 1\n", instruction.x, instruction.x);
+    unsigned short mask = addressMask;
+    
+    for (int i = 0; i <= instruction.x; i++)
+    {
+        memory[(I + i) & mask] = registers[i];
+    }
+    
+    if (recompiler != nullptr)
+        recompiler->invalidate(I, instruction.x + 1);
+    
+    //The COSMAC VIP moved I along as it went
+    if (Q & QUIRK_MEMORY_INCREMENT)
+        I += instruction.x + 1;
+}
+
+template <unsigned Q>
+void Core::opLdRegs (const Instruction& instruction)
+{
+    //printf("Fill registers v0 to v%x from memory starting at I, I becomes I + %x + 1\n", instruction.x, instruction.x);
+    unsigned short mask = addressMask;
+    
+    for (int i = 0; i <= instruction.x; i++)
+    {
+        registers[i] = memory[(I + i) & mask];
+    }
+    
+    if (Q & QUIRK_MEMORY_INCREMENT)
+        I += instruction.x + 1;
+}
+
+void Core::skip ()
+{
+    //F000 carries its address in the next two bytes, stepping into those would run them as an opcode
+    bool isLong = mode == MODE_XOCHIP && memory[pc & addressMask] == 0xF0 && memory[(pc + 1) & addressMask] == 0x00;
+    
+    pc += isLong ? 4 : 2;
+}
+
+void Core::setResolution (bool high)
+{
+    displayWidth = high ? maxDisplayWidth : 64;
+    displayHeight = high ? maxDisplayHeight : 32;
+    
+    //The layout of the rows changes with the width, nothing drawn before means anything after
+    memset(display, 0, sizeof(display));
+    dirtyRows = ~0ull;
+}
+
+void Core::scrollVertical (int rows)
+{
+    int rowWords = displayWidth / 64;
+    int planeWords = displayHeight * rowWords;
+    int count = min(abs(rows), displayHeight);
+    int moved = (displayHeight - count) * rowWords;
+    
+    for (int plane = 0; plane < maxPlanes; plane++)
+    {
+        if ((planeMask & (1 << plane)) == 0)
+            continue;
+        
+        uint64_t* bits = &display[plane * planeWords];
+        
+        //Whole rows at a time, what comes in at the edge is blank
+        if (rows > 0)
+        {
+            memmove(&bits[count * rowWords], bits, moved * sizeof(uint64_t));
+            memset(bits, 0, count * rowWords * sizeof(uint64_t));
+        }
+        else
+        {
+            memmove(bits, &bits[count * rowWords], moved * sizeof(uint64_t));
+            memset(&bits[moved], 0, count * rowWords * sizeof(uint64_t));
+        }
+    }
+    
+    dirtyRows = ~0ull;
+}
+
+void Core::scrollHorizontal (int columns)
+{
+    int rowWords = displayWidth / 64;
+    int planeWords = displayHeight * rowWords;
+    int count = abs(columns);
+    
+    for (int plane = 0; plane < maxPlanes; plane++)
+    {
+        if ((planeMask & (1 << plane)) == 0)
+            continue;
+        
+        uint64_t* bits = &display[plane * planeWords];
+        
+        //A shift per word, with what falls off one word carried into the next
+        for (int row = 0; row < displayHeight; row++)
+        {
+            uint64_t* words = &bits[row * rowWords];
+            
+            if (columns > 0)
+            {
+                for (int i = rowWords - 1; i > 0; i--)
+                    words[i] = (words[i] >> count) | (words[i - 1] << (64 - count));
+                
+                words[0] >>= count;
+            }
+            else
+            {
+                for (int i = 0; i < rowWords - 1; i++)
+                    words[i] = (words[i] << count) | (words[i + 1] >> (64 - count));
+                
+                words[rowWords - 1] <<= count;
+            }
+        }
+    }
+    
+    dirtyRows = ~0ull;
+}
+
+//Scrolls move the display's own pixels, so in 64x32 they're already twice as far as in 128x64 - the same
+//distance on screen as SUPER-CHIP 1.1 with its lores pixels doubled. Nothing needs scaling here
+void Core::opScd (const Instruction& instruction)
+{
+    //printf("Scroll down %d rows\n", instruction.n);
+    scrollVertical(instruction.n);
+}
+
+void Core::opScr (const Instruction& instruction)
+{
+    //printf("Scroll right 4 pixels\n");
+    scrollHorizontal(4);
+}
+
+void Core::opScl (const Instruction& instruction)
+{
+    //printf("Scroll left 4 pixels\n");
+    scrollHorizontal(-4);
+}
+
+void Core::opExit (const Instruction& instruction)
+{
+    //printf("Exit the interpreter\n");
+    //Stays on the 00FD like a jump to itself would
+    pc -= 2;
+    status = STATUS_HALTED;
+}
+
+void Core::opLow (const Instruction& instruction)
+{
+    //printf("Switch to 64x32\n");
+    setResolution(false);
+}
+
+void Core::opHigh (const Instruction& instruction)
+{
+    //printf("Switch to 128x64\n");
+    setResolution(true);
+}
+
+void Core::opLdHf (const Instruction& instruction)
+{
+    //printf("Set I to address of big sprite data in %x\n", instruction.x);
+    I = bigFontStart + (registers[instruction.x] & 0xF) * 10;
+}
+
+void Core::opSaveFlags (const Instruction& instruction)
+{
+    //printf("Store v0 to v%x in the user flags\n", instruction.x);
+    //SUPER-CHIP only has 8 of them
+    int last = mode == MODE_XOCHIP ? instruction.x : instruction.x & 7;
+    memcpy(flags, registers, last + 1);
+}
+
+void Core::opLoadFlags (const Instruction& instruction)
+{
+    //printf("Fill v0 to v%x from the user flags\n", instruction.x);
+    int last = mode == MODE_XOCHIP ? instruction.x : instruction.x & 7;
+    memcpy(registers, flags, last + 1);
+}
+
+void Core::opScu (const Instruction& instruction)
+{
+    //printf("Scroll up %d rows\n", instruction.n);
+    scrollVertical(-instruction.n);
+}
+
+void Core::opSaveRange (const Instruction& instruction)
+{
+    //printf("Store v%x to v%x to memory starting at I\n", instruction.x, instruction.y);
+    //Either way round, I doesn't move
+    int step = instruction.x <= instruction.y ? 1 : -1;
+    int count = abs(instruction.y - instruction.x) + 1;
+    
+    for (int i = 0; i < count; i++)
+        memory[(I + i) & addressMask] = registers[instruction.x + i * step];
+    
+    if (recompiler != nullptr)
+        recompiler->invalidate(I, count);
+}
+
+void Core::opLoadRange (const Instruction& instruction)
+{
+    //printf("Fill v%x to v%x from memory starting at I\n", instruction.x, instruction.y);
+    int step = instruction.x <= instruction.y ? 1 : -1;
+    int count = abs(instruction.y - instruction.x) + 1;
+    
+    for (int i = 0; i < count; i++)
+        registers[instruction.x + i * step] = memory[(I + i) & addressMask];
+}
+
+void Core::opLdILong (const Instruction& instruction)
+{
+    //printf("Store the next 16 bits in I\n");
+    I = (memory[pc & addressMask] << 8) | memory[(pc + 1) & addressMask];
+    pc += 2;
+}
+
+void Core::opPlane (const Instruction& instruction)
+{
+    //printf("Select planes %x\n", instruction.x);
+    planeMask = instruction.x & ((1 << maxPlanes) - 1);
+}
+
+void Core::opAudio (const Instruction& instruction)
+{
+    //printf("Load the audio pattern from I\n");
+    for (size_t i = 0; i < sizeof(pattern); i++)
+        pattern[i] = memory[(I + i) & addressMask];
+    
+    if (audio != nullptr)
+        audio->setPattern(pattern);
+}
+
+void Core::opPitch (const Instruction& instruction)
+{
+    //printf("Set the pitch to %x\n", instruction.x);
+    pitch = registers[instruction.x];
+    
+    if (audio != nullptr)
+        audio->setPitch(pitch);
+}
+
+void Core::opUnhandled (const Instruction& instruction)
+{
+    //pc has already moved past it - step back so the rest of the frame just sits here, run stops after it
+    pc -= 2;
+    
+    unsigned short address = pc & addressMask;
+    unhandledOpcode = (memory[address] << 8) | memory[(address + 1) & addressMask];
+    status = STATUS_UNHANDLED_OPCODE;
+}
+
+void Core::emulateCycle()
+{
+    emulateCycle(addressMask);
+}
+
+inline void Core::emulateCycle(unsigned short mask)
+{
+    unsigned short opcode = (memory[pc & mask] << 8) | memory[(pc + 1) & mask];
+    //printf("%x %d\n", opcode, pc);
+    
+    pc += 2;
+    cycles++;
+    
+#ifdef CHIP8_PROFILE
+    if (profiler != nullptr)
+    {
+        profiler->instruction(pc - 2, decodeTable[opcode]);
+        
+        if (decodeTable[opcode].op == OP_DRW)
+        {
+            uint64_t start = Profiler::now();
+            execute(decodeTable[opcode]);
+            profiler->addDrawTime(Profiler::now() - start);
+            return;
+        }
+    }
+#endif
+    
+    execute(decodeTable[opcode]);
+}
+
+void Core::setDispatch(Dispatch newDispatch)
+{
+    dispatch = newDispatch;
+    
+    if (dispatch == DISPATCH_RECOMPILER || dispatch == DISPATCH_RECOMPILER_PORTABLE)
+        recompiler.reset(new Recompiler(*this, dispatch == DISPATCH_RECOMPILER));
+    else
+        recompiler.reset();
+}
+
+void Core::emulateCycles(int count)
+{
+#ifdef CHIP8_PROFILE
+    //Whatever the dispatch, so every instruction goes past the profiler
+    if (profiler != nullptr)
+    {
+        uint64_t start = Profiler::now();
+        
+        for (int i = 0; i < count && !waitingForKey; i++)
+            emulateCycle();
+        
+        profiler->addEmulationTime(Profiler::now() - start);
+        return;
+    }
+#endif
+    
+    if (dispatch == DISPATCH_THREADED)
+    {
+        (this->*threadedLoop)(count);
+        return;
+    }
+    
+    if (recompiler != nullptr)
+    {
+        recompiler->run(count);
+        return;
+    }
+    
+    //Can't change while instructions run
+    unsigned short mask = addressMask;
+    
+    for (int i = 0; i < count; i++)
+    {
+        //emulate cycle
+        emulateCycle(mask);
+        
+        //Fx0A found no key, nothing else runs this frame
+        if (waitingForKey)
+            break;
+    }
+}
+
+template <unsigned Q>
+void Core::emulateCyclesThreaded(int count)
+{
+    //Counted up front, an Fx0A that stops the frame early takes back what didn't run
+    cycles += count;
+    
+    const Instruction* instruction;
+    //Nothing in the loop can change the mode, and a local stays in a register where the member would be read again
+    //after every memory write
+    const unsigned short mask = addressMask;
+    
+#if defined(__GNUC__) || defined(__clang__)
+    //Direct threaded - every handler jumps straight to the next one, so each op gets its own indirect branch
+    //that the predictor can learn instead of everything going through one switch
+    //Must be in the same order as Op
+    static void* const labels [OP_COUNT] = {
+        &&sys, &&cls, &&ret, &&jp, &&call,
+        &&seByte, &&sneByte, &&seReg, &&ldByte, &&addByte,
+        &&ldReg, &&orReg, &&andReg, &&xorReg, &&addReg,
+        &&sub, &&shr, &&subn, &&shl, &&sneReg,
+        &&ldI, &&jpV0, &&rnd, &&drw, &&skp, &&sknp,
+        &&ldVxDt, &&ldVxK, &&ldDt, &&ldSt, &&addI,
+        &&ldF, &&ldB, &&ldMem, &&ldRegs,
+        &&scd, &&scr, &&scl, &&exitInterpreter, &&low, &&high,
+        &&ldHf, &&saveFlags, &&loadFlags,
+        &&scu, &&saveRange, &&loadRange, &&ldILong, &&plane, &&audioPattern, &&pitchReg,
+        &&unhandled
+    };
+    
+#define DISPATCH() \
+    if (count-- <= 0) \
+        return; \
+    instruction = &decodeTable[(memory[pc & mask] << 8) | memory[(pc + 1) & mask]]; \
+    pc += 2; \
+    goto *labels[instruction->op]
+    
+    DISPATCH();
+    
+    sys:        opSys(*instruction);        DISPATCH();
+    cls:        opCls(*instruction);        DISPATCH();
+    ret:        opRet(*instruction);        DISPATCH();
+    jp:         opJp(*instruction);         DISPATCH();
+    call:       opCall(*instruction);       DISPATCH();
+    seByte:     opSeByte(*instruction);     DISPATCH();
+    sneByte:    opSneByte(*instruction);    DISPATCH();
+    seReg:      opSeReg(*instruction);      DISPATCH();
+    ldByte:     opLdByte(*instruction);     DISPATCH();
+    addByte:    opAddByte(*instruction);    DISPATCH();
+    ldReg:      opLdReg(*instruction);      DISPATCH();
+    orReg:      opOr<Q>(*instruction);      DISPATCH();
+    andReg:     opAnd<Q>(*instruction);     DISPATCH();
+    xorReg:     opXor<Q>(*instruction);     DISPATCH();
+    addReg:     opAddReg(*instruction);     DISPATCH();
+    sub:        opSub(*instruction);        DISPATCH();
+    shr:        opShr<Q>(*instruction);     DISPATCH();
+    subn:       opSubn(*instruction);       DISPATCH();
+    shl:        opShl<Q>(*instruction);     DISPATCH();
+    sneReg:     opSneReg(*instruction);     DISPATCH();
+    ldI:        opLdI(*instruction);        DISPATCH();
+    jpV0:       opJpV0<Q>(*instruction);    DISPATCH();
+    rnd:        opRnd(*instruction);        DISPATCH();
+    drw:        opDrw<Q>(*instruction);     DISPATCH();
+    skp:        opSkp(*instruction);        DISPATCH();
+    sknp:       opSknp(*instruction);       DISPATCH();
+    ldVxDt:     opLdVxDt(*instruction);     DISPATCH();
+    ldVxK:      opLdVxK(*instruction);      if (waitingForKey) { cycles -= count; return; } DISPATCH();
+    ldDt:       opLdDt(*instruction);       DISPATCH();
+    ldSt:       pendingCycles = count; opLdSt(*instruction); DISPATCH();
+    addI:       opAddI(*instruction);       DISPATCH();
+    ldF:        opLdF(*instruction);        DISPATCH();
+    ldB:        opLdB(*instruction);        DISPATCH();
+    ldMem:      opLdMem<Q>(*instruction);   DISPATCH();
+    ldRegs:     opLdRegs<Q>(*instruction);  DISPATCH();
+    scd:        opScd(*instruction);        DISPATCH();
+    scr:        opScr(*instruction);        DISPATCH();
+    scl:        opScl(*instruction);        DISPATCH();
+    exitInterpreter: opExit(*instruction); DISPATCH();
+    low:        opLow(*instruction);        DISPATCH();
+    high:       opHigh(*instruction);       DISPATCH();
+    ldHf:       opLdHf(*instruction);       DISPATCH();
+    saveFlags:  opSaveFlags(*instruction);  DISPATCH();
+    loadFlags:  opLoadFlags(*instruction);  DISPATCH();
+    scu:        opScu(*instruction);        DISPATCH();
+    saveRange:  opSaveRange(*instruction);  DISPATCH();
+    loadRange:  opLoadRange(*instruction);  DISPATCH();
+    ldILong:    opLdILong(*instruction);    DISPATCH();
+    plane:      opPlane(*instruction);      DISPATCH();
+    audioPattern: opAudio(*instruction);    DISPATCH();
+    pitchReg:   opPitch(*instruction);      DISPATCH();
+    unhandled:  opUnhandled(*instruction);  DISPATCH();
+    
+#undef DISPATCH
+#else
+    //No computed goto - a single switch the compiler can turn into one jump table with the handlers inlined
+    while (count-- > 0)
+    {
+        instruction = &decodeTable[(memory[pc & mask] << 8) | memory[(pc + 1) & mask]];
+        pc += 2;
+        
+        switch (instruction->op)
+        {
+            case OP_SYS: opSys(*instruction); break;
+            case OP_CLS: opCls(*instruction); break;
+            case OP_RET: opRet(*instruction); break;
+            case OP_JP: opJp(*instruction); break;
+            case OP_CALL: opCall(*instruction); break;
+            case OP_SE_BYTE: opSeByte(*instruction); break;
+            case OP_SNE_BYTE: opSneByte(*instruction); break;
+            case OP_SE_REG: opSeReg(*instruction); break;
+            case OP_LD_BYTE: opLdByte(*instruction); break;
+            case OP_ADD_BYTE: opAddByte(*instruction); break;
+            case OP_LD_REG: opLdReg(*instruction); break;
+            case OP_OR: opOr<Q>(*instruction); break;
+            case OP_AND: opAnd<Q>(*instruction); break;
+            case OP_XOR: opXor<Q>(*instruction); break;
+            case OP_ADD_REG: opAddReg(*instruction); break;
+            case OP_SUB: opSub(*instruction); break;
+            case OP_SHR: opShr<Q>(*instruction); break;
+            case OP_SUBN: opSubn(*instruction); break;
+            case OP_SHL: opShl<Q>(*instruction); break;
+            case OP_SNE_REG: opSneReg(*instruction); break;
+            case OP_LD_I: opLdI(*instruction); break;
+            case OP_JP_V0: opJpV0<Q>(*instruction); break;
+            case OP_RND: opRnd(*instruction); break;
+            case OP_DRW: opDrw<Q>(*instruction); break;
+            case OP_SKP: opSkp(*instruction); break;
+            case OP_SKNP: opSknp(*instruction); break;
+            case OP_LD_VX_DT: opLdVxDt(*instruction); break;
+            case OP_LD_VX_K:
+                opLdVxK(*instruction);
+                
+                if (waitingForKey)
+                {
+                    cycles -= count;
+                    return;
+                }
+                break;
+            case OP_LD_DT: opLdDt(*instruction); break;
+            case OP_LD_ST: pendingCycles = count; opLdSt(*instruction); break;
+            case OP_ADD_I: opAddI(*instruction); break;
+            case OP_LD_F: opLdF(*instruction); break;
+            case OP_LD_B: opLdB(*instruction); break;
+            case OP_LD_MEM: opLdMem<Q>(*instruction); break;
+            case OP_LD_REGS: opLdRegs<Q>(*instruction); break;
+            case OP_SCD: opScd(*instruction); break;
+            case OP_SCR: opScr(*instruction); break;
+            case OP_SCL: opScl(*instruction); break;
+            case OP_EXIT: opExit(*instruction); break;
+            case OP_LOW: opLow(*instruction); break;
+            case OP_HIGH: opHigh(*instruction); break;
+            case OP_LD_HF: opLdHf(*instruction); break;
+            case OP_SAVE_FLAGS: opSaveFlags(*instruction); break;
+            case OP_LOAD_FLAGS: opLoadFlags(*instruction); break;
+            case OP_SCU: opScu(*instruction); break;
+            case OP_SAVE_RANGE: opSaveRange(*instruction); break;
+            case OP_LOAD_RANGE: opLoadRange(*instruction); break;
+            case OP_LD_I_LONG: opLdILong(*instruction); break;
+            case OP_PLANE: opPlane(*instruction); break;
+            case OP_AUDIO: opAudio(*instruction); break;
+            case OP_PITCH: opPitch(*instruction); break;
+            default: opUnhandled(*instruction); break;
+        }
+    }
+#endif
+}
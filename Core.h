@@ -0,0 +1,366 @@
+//
+//  Core.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Core__
+#define __Chip8__Core__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <memory>
+
+#include <assert.h>
+
+#include "Decode.h"
+#include "Frontend.h"
+#include "Pacer.h"
+#include "Profiler.h"
+#include "Quirks.h"
+#include "Snapshot.h"
+
+class Recompiler;
+
+//Interpreter backends, picked once at startup
+enum Dispatch
+{
+    //Look up the decode table and call through the handler pointer table
+    DISPATCH_TABLE,
+    //Computed goto between handlers where the compiler supports it, single switch otherwise
+    DISPATCH_THREADED,
+    //Cached basic blocks, x86-64 machine code where available
+    DISPATCH_RECOMPILER,
+    //Cached basic blocks as chains of handler calls, never native code
+    DISPATCH_RECOMPILER_PORTABLE
+};
+
+enum Status
+{
+    STATUS_RUNNING,
+    //Jumped to itself, nothing more will ever happen
+    STATUS_HALTED,
+    //Hit an opcode the interpreter doesn't know, pc is left on it
+    STATUS_UNHANDLED_OPCODE
+};
+
+//Headless Chip8 machine - CPU state, memory, display and the interpreter. Doesn't know anything about SDL,
+//input, video and frame pacing come in through the interfaces in Frontend.h
+class Core
+{
+public:
+    Core();
+    ~Core();
+
+    void reset ();
+    //Which machine to be, resets it and picks the mode's default quirks. Load the ROM after, the mode decides how
+    //much memory there is for it
+    void setMode (Mode newMode);
+    Mode getMode () const { return mode; }
+    //Any combination of Quirk bits, switches to the interpreter compiled for it. Doesn't touch the machine
+    void setQuirks (uint8_t newQuirks);
+    uint8_t getQuirks () const { return quirks; }
+    //Maps the file and loads it through loadROM, false with the reason on stderr if it's empty or doesn't fit
+    bool loadFile (const char* location);
+    bool loadROM (const unsigned char* data, size_t size);
+
+    //Machine state only, the settings below stay as they are. loadState returns false for a snapshot from
+    //another version or build
+    void saveState (Snapshot& snapshot) const;
+    bool loadState (const Snapshot& snapshot);
+
+    void setInput (Input* newInput) { input = newInput; }
+    void setVideo (Video* newVideo) { video = newVideo; }
+    void setTimer (Timer* newTimer) { timer = newTimer; }
+    void setAudio (Audio* newAudio) { audio = newAudio; }
+    //Only does anything when built with CHIP8_PROFILE. Everything runs one instruction at a time while it's set
+    void setProfiler (Profiler* newProfiler) { profiler = newProfiler; }
+
+    //Runs frames (timer ticks) until the input frontend asks to stop, the program stops or frames have been
+    //run if frames >= 0. Returns how many frames ran
+    long run (long frames = -1);
+    //One timer tick worth of instructions then the tick itself, nothing is presented
+    void emulateFrame ();
+    void emulateCycle ();
+    //count instructions through whichever backend is selected
+    void emulateCycles (int count);
+    void updateTimers ();
+    //Hands the display to the Video frontend if anything changed since last time
+    void renderDisplay ();
+    
+    //Instructions executed since reset
+    uint64_t getCycles () const { return cycles; }
+
+    bool isLoaded () const { return fileLoaded; }
+    //hashROM of what was last loaded, for looking it up in a QuirkDatabase or RomIndex
+    uint64_t getROMHash () const { return romHash; }
+    //Bytes from memoryStart the ROM took up
+    size_t getROMSize () const { return romSize; }
+    Status getStatus () const { return status; }
+    unsigned short getUnhandledOpcode () const { return unhandledOpcode; }
+    //Stopped on Fx0A until the Input has a key
+    bool isWaitingForKey () const { return waitingForKey; }
+
+    //Width / 64 uint64_t per row, bit 63 of a row's first word is x = 0. Planes follow each other, plane p
+    //starts p * height rows in
+    const uint64_t* getDisplay () const { return display; }
+    bool getPixel (int x, int y, int plane = 0) const
+    {
+        int rowWords = displayWidth / 64;
+        return (display[(plane * displayHeight + y) * rowWords + x / 64] >> (63 - x % 64)) & 1;
+    }
+    //FNV-1a over the packed rows of every plane the mode has
+    uint64_t hashDisplay () const;
+    int getDisplayWidth () const { return displayWidth; }
+    int getDisplayHeight () const { return displayHeight; }
+    //1 apart from XO-CHIP
+    int getDisplayPlanes () const { return mode == MODE_XOCHIP ? maxPlanes : 1; }
+    //How much of the start of the display the mode and resolution use, the rest is always clear
+    size_t getDisplayBytes () const { return getDisplayPlanes() * displayHeight * (displayWidth / 64) * sizeof(uint64_t); }
+    
+    //Largest display any mode has
+    static const int maxDisplayWidth = 128;
+    static const int maxDisplayHeight = 64;
+    static const int maxPlanes = 4;
+
+    const unsigned char* getMemory () const { return memory; }
+    //4K, or 64K on XO-CHIP
+    size_t getMemorySize () const { return memorySize; }
+    //Biggest ROM any mode has room for, loadFile / loadROM still hold it to the current mode's
+    static const size_t maxROMSize = 0x10000 - 0x200;
+    const unsigned char* getRegisters () const { return registers; }
+    unsigned short getI () const { return I; }
+    unsigned short getPC () const { return pc; }
+    unsigned char getDelayTimer () const { return dt; }
+    unsigned char getSoundTimer () const { return st; }
+    //Where the CXNN sequence is now, seed() with it to carry on the same sequence
+    uint32_t getRandomState () const { return randomState; }
+    int getInstructionRate () const { return instructionRate; }
+    int getTimerRate () const { return timerRate; }
+
+    //Emulated instructions per second
+    void setInstructionRate (int rate) { instructionRate = rate; }
+    //Delay and sound timer decrements per second, also the length of a frame in run
+    void setTimerRate (int rate) { timerRate = rate; }
+    //Frames presented per second
+    void setPresentRate (int rate) { presentRate = rate; }
+    //Don't hold emulated time to wall time, presentation is sampled at presentRate of real time instead
+    void setTurbo (bool enabled) { turbo = enabled; }
+    void setCyclesPerFrame (int count) { instructionRate = count * timerRate; }
+    //CXNN random number sequence, 0 picks the default
+    void seed (uint32_t value);
+    void setDispatch (Dispatch newDispatch);
+    //Skip the rest of a frame spent in a loop that only waits on the delay timer or the keys, and halt on
+    //loops (a jump to itself, or an Fx0A with no Input) that can never end once the sound timer has run out.
+    //The skipping is exact, only the halting shows - with this off only 00FD and unhandled opcodes stop a Core
+    void setIdleSkip (bool enabled) { idleSkip = enabled; }
+    
+    //Holds run to timerRate when there's a Timer, for its jitter stats and vsync alignment
+    Pacer& getPacer () { return pacer; }
+
+private:
+    friend class Recompiler;
+    //Runs instructions through its own checking loop, so none of the loops here ever look for breakpoints
+    friend class Debugger;
+    
+    typedef void (Core::*Handler) (const Instruction& instruction);
+    typedef void (Core::*Loop) (int count);
+    //Handlers for one combination of quirks, Q is the Quirk bits
+    template <unsigned Q> static const Handler handlerTable [OP_COUNT];
+    //Every combination's handlers and threaded loop, indexed by the quirk bits
+    static const Handler* const handlerTables [quirkCombinations];
+    static const Loop threadedLoops [quirkCombinations];
+    
+    void execute (const Instruction& instruction) { (this->*handlers[instruction.op])(instruction); }
+    
+    //0
+    void opSys (const Instruction& instruction);
+    void opCls (const Instruction& instruction);
+    void opRet (const Instruction& instruction);
+    //1, 2, B
+    void opJp (const Instruction& instruction);
+    void opCall (const Instruction& instruction);
+    template <unsigned Q> void opJpV0 (const Instruction& instruction);
+    //3, 4, 5, 9
+    void opSeByte (const Instruction& instruction);
+    void opSneByte (const Instruction& instruction);
+    void opSeReg (const Instruction& instruction);
+    void opSneReg (const Instruction& instruction);
+    //6, 7
+    void opLdByte (const Instruction& instruction);
+    void opAddByte (const Instruction& instruction);
+    //8
+    void opLdReg (const Instruction& instruction);
+    template <unsigned Q> void opOr (const Instruction& instruction);
+    template <unsigned Q> void opAnd (const Instruction& instruction);
+    template <unsigned Q> void opXor (const Instruction& instruction);
+    void opAddReg (const Instruction& instruction);
+    void opSub (const Instruction& instruction);
+    template <unsigned Q> void opShr (const Instruction& instruction);
+    void opSubn (const Instruction& instruction);
+    template <unsigned Q> void opShl (const Instruction& instruction);
+    //A, C, D
+    void opLdI (const Instruction& instruction);
+    void opRnd (const Instruction& instruction);
+    template <unsigned Q> void opDrw (const Instruction& instruction);
+    //E
+    void opSkp (const Instruction& instruction);
+    void opSknp (const Instruction& instruction);
+    //F
+    void opLdVxDt (const Instruction& instruction);
+    void opLdVxK (const Instruction& instruction);
+    void opLdDt (const Instruction& instruction);
+    void opLdSt (const Instruction& instruction);
+    void opAddI (const Instruction& instruction);
+    void opLdF (const Instruction& instruction);
+    void opLdB (const Instruction& instruction);
+    template <unsigned Q> void opLdMem (const Instruction& instruction);
+    template <unsigned Q> void opLdRegs (const Instruction& instruction);
+    //SUPER-CHIP
+    void opScd (const Instruction& instruction);
+    void opScr (const Instruction& instruction);
+    void opScl (const Instruction& instruction);
+    void opExit (const Instruction& instruction);
+    void opLow (const Instruction& instruction);
+    void opHigh (const Instruction& instruction);
+    void opLdHf (const Instruction& instruction);
+    void opSaveFlags (const Instruction& instruction);
+    void opLoadFlags (const Instruction& instruction);
+    //XO-CHIP
+    void opScu (const Instruction& instruction);
+    void opSaveRange (const Instruction& instruction);
+    void opLoadRange (const Instruction& instruction);
+    void opLdILong (const Instruction& instruction);
+    void opPlane (const Instruction& instruction);
+    void opAudio (const Instruction& instruction);
+    void opPitch (const Instruction& instruction);
+    
+    void opUnhandled (const Instruction& instruction);
+    
+    //DXYN outside plain CHIP-8 - 16x16 sprites, 128 wide rows, planes, clipping
+    template <unsigned Q> void drawExtended (const Instruction& instruction);
+    //Every selected plane moved by rows down (negative is up) or by columns right (negative is left)
+    void scrollVertical (int rows);
+    void scrollHorizontal (int columns);
+    //Switches between 64x32 and 128x64, clears the display
+    void setResolution (bool high);
+    //Skips the next instruction, which is 4 bytes if it's an XO-CHIP F000
+    void skip ();
+    
+    //emulateCycle with addressMask already in hand, for loops that can keep it in a register
+    void emulateCycle (unsigned short mask);
+    template <unsigned Q> void emulateCyclesThreaded (int count);
+    //Fast forwards through an idle loop at pc, returns how many of count instructions still have to run
+    int skipIdleLoop (int count);
+    //Longest loop skipIdleLoop looks for
+    static const int maxIdleLoop = 16;
+    
+    //emulateFrame without the instructions. startFrame hands out the frame's instruction budget, 0 while Fx0A is
+    //waiting, and soundOn for finishFrame, which ticks the audio and timers
+    int startFrame (bool& soundOn);
+    void finishFrame (bool soundOn);
+    
+    unsigned char random();
+
+
+    ////////////////////////
+    //      Variables     //
+    ////////////////////////
+    Input* input;
+    Video* video;
+    Timer* timer;
+    Audio* audio;
+    Profiler* profiler;
+
+    bool fileLoaded;
+    uint64_t romHash;
+    size_t romSize;
+    Status status;
+    unsigned short unhandledOpcode;
+    
+    //Fx0A wait state and the register the key goes in
+    bool waitingForKey;
+    unsigned char keyRegister;
+
+    Mode mode;
+    uint8_t quirks;
+    //From handlerTables and threadedLoops for the quirks
+    const Handler* handlers;
+    Loop threadedLoop;
+    
+    //4k, XO-CHIP gets all 64k
+    unsigned char memory [0x10000];
+    //0x0 - 0x200 is used for the intepreter, so actual memory starts at 0x200
+    const int memoryStart;
+    size_t memorySize;
+    //Addresses wrap at the end of memory
+    unsigned short addressMask;
+
+    //General registers - VF is a special flag
+    unsigned char registers [16];
+    //Special register used to store memory addresses
+    unsigned short I;
+
+    //Program counter - moved past the current instruction before it executes
+    unsigned short pc;
+    //Stack pointer - Topmost level of the stack
+    unsigned char sp;
+    //Stack - used to store return address when leaving subroutines
+    unsigned short stack [16];
+
+    //Sound and delay - decrement at a rate of 60hz
+    //Sound timer - sounds as long as the value is greater than 0 - single tone, frequency = whatever
+    unsigned char st;
+    //Fx18 turning the tone on or off this frame, as fractions of the frame
+    static const int maxSoundEdges = 8;
+    float soundEdges [maxSoundEdges];
+    int soundEdgeCount;
+    //Delay timer - just decrements
+    unsigned char dt;
+
+    //Display
+    int displayWidth;
+    int displayHeight;
+    //Packed a bit per pixel so a sprite row is one shift and XOR, and a scroll is a move of whole words
+    uint64_t display [maxPlanes * maxDisplayHeight * maxDisplayWidth / 64];
+    //Bit per row changed since the last present
+    uint64_t dirtyRows;
+    //XO-CHIP planes DXYN and the scrolls and clears work on, bit per plane
+    unsigned char planeMask;
+    
+    //SUPER-CHIP RPL user flags, Fx75 / Fx85
+    unsigned char flags [16];
+    //XO-CHIP audio - 128 one bit samples and the rate they play at
+    unsigned char pattern [16];
+    unsigned char pitch;
+
+    int fps;
+    int instructionRate;
+    int timerRate;
+    int presentRate;
+    bool turbo;
+    Pacer pacer;
+    //Instructions owed to the next tick, in 1/timerRate steps
+    long instructionCredit;
+    uint64_t cycles;
+    //cycles when the frame started and how many it runs
+    uint64_t frameStartCycles;
+    int frameCycles;
+    //Instructions the threaded loop has already added to cycles but not run yet, set for Fx18
+    int pendingCycles;
+    Dispatch dispatch;
+    bool idleSkip;
+    std::unique_ptr<Recompiler> recompiler;
+    
+    const Instruction* decodeTable;
+
+    //Random numbers
+    uint32_t randomState;
+};
+
+#endif /* defined(__Chip8__Core__) */
@@ -0,0 +1,194 @@
+//
+//  Debugger.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Debugger.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+Debugger::Debugger(Core& core) : core(core)
+{
+    memset(breakpoints, 0, sizeof(breakpoints));
+    breakpointCount = 0;
+
+    frame = 0;
+    inFrame = false;
+    remaining = 0;
+    soundOn = false;
+}
+
+void Debugger::setBreakpoint(unsigned short address, bool enabled)
+{
+    if (isBreakpoint(address) == enabled)
+        return;
+
+    breakpoints[address >> 6] ^= 1ull << (address & 63);
+    breakpointCount += enabled ? 1 : -1;
+}
+
+void Debugger::clearBreakpoints()
+{
+    memset(breakpoints, 0, sizeof(breakpoints));
+    breakpointCount = 0;
+}
+
+void Debugger::watchMemory(unsigned short address)
+{
+    address &= core.addressMask;
+    memoryWatches.push_back(make_pair(address, core.memory[address]));
+}
+
+void Debugger::watchRegister(int index)
+{
+    registerWatches.push_back(make_pair(index, index == registerI ? core.I : core.registers[index & 0xF]));
+}
+
+void Debugger::clearWatchpoints()
+{
+    memoryWatches.clear();
+    registerWatches.clear();
+}
+
+Debugger::Stop Debugger::step()
+{
+    return resume(LONG_MAX, true, -1);
+}
+
+Debugger::Stop Debugger::stepOver()
+{
+    unsigned short address = core.pc & core.addressMask;
+    unsigned short opcode = (core.memory[address] << 8) | core.memory[(address + 1) & core.addressMask];
+
+    if (core.decodeTable[opcode].op != OP_CALL)
+        return step();
+
+    return resume(LONG_MAX, true, core.sp);
+}
+
+Debugger::Stop Debugger::runToFrame(long stopFrame)
+{
+    return resume(stopFrame, false, -1);
+}
+
+Debugger::Stop Debugger::run()
+{
+    return resume(LONG_MAX, false, -1);
+}
+
+bool Debugger::checkWatchpoints()
+{
+    char text [64];
+    bool hit = false;
+
+    //Every one is brought up to date, so carrying on doesn't stop again for the same change
+    for (pair<unsigned short, uint8_t>& watch : memoryWatches)
+    {
+        uint8_t value = core.memory[watch.first];
+
+        if (value != watch.second && !hit)
+        {
+            snprintf(text, sizeof(text), "[%04X] %02X -> %02X", watch.first, watch.second, value);
+            watchHit = text;
+            hit = true;
+        }
+
+        watch.second = value;
+    }
+
+    for (pair<int, uint16_t>& watch : registerWatches)
+    {
+        uint16_t value = watch.first == registerI ? core.I : core.registers[watch.first & 0xF];
+
+        if (value != watch.second && !hit)
+        {
+            if (watch.first == registerI)
+                snprintf(text, sizeof(text), "I %03X -> %03X", watch.second, value);
+            else
+                snprintf(text, sizeof(text), "V%X %02X -> %02X", watch.first, watch.second, value);
+
+            watchHit = text;
+            hit = true;
+        }
+
+        watch.second = value;
+    }
+
+    return hit;
+}
+
+Debugger::Stop Debugger::resume(long stopFrame, bool stepping, int returnDepth)
+{
+    //A breakpoint stops before its instruction, carrying on has to run it rather than stop there again
+    bool first = true;
+    bool watching = !memoryWatches.empty() || !registerWatches.empty();
+
+    for (;;)
+    {
+        if (!inFrame)
+        {
+            if (core.status != STATUS_RUNNING)
+                return STOP_HALTED;
+
+            if (frame >= stopFrame)
+                return STOP_FRAME;
+
+            //Nothing to check - straight through whichever dispatch the Core is using
+            if (!stepping && breakpointCount == 0 && !watching)
+            {
+                core.emulateFrame();
+                frame++;
+                continue;
+            }
+
+            remaining = core.startFrame(soundOn);
+            inFrame = true;
+        }
+
+        //The same as emulateCycle, with the checks either side. Like every dispatch it carries on to the end of the
+        //frame whatever the status, it's only looked at between frames. Idle loops aren't skipped, something in
+        //them might be what's being looked for
+        while (remaining > 0)
+        {
+            unsigned short mask = core.addressMask;
+            unsigned short address = core.pc & mask;
+
+            if (breakpointCount > 0 && !first && isBreakpoint(address))
+                return STOP_BREAKPOINT;
+
+            first = false;
+
+            unsigned short opcode = (core.memory[address] << 8) | core.memory[(address + 1) & mask];
+
+            core.pc += 2;
+            core.cycles++;
+            core.execute(core.decodeTable[opcode]);
+            remaining--;
+
+            //Fx0A found no key, the Core runs nothing else this frame either
+            if (core.waitingForKey)
+                remaining = 0;
+
+            if (watching && checkWatchpoints())
+                return STOP_WATCHPOINT;
+
+            if (stepping && (returnDepth < 0 || (int8_t) (core.sp - returnDepth) <= 0))
+                return STOP_STEP;
+        }
+
+        core.finishFrame(soundOn);
+        inFrame = false;
+        frame++;
+
+        //A whole frame went by without an instruction, Fx0A is waiting on a key
+        if (stepping && first)
+            return STOP_FRAME;
+    }
+}
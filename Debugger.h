@@ -0,0 +1,92 @@
+//
+//  Debugger.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Debugger__
+#define __Chip8__Debugger__
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Core.h"
+
+//Drives a Core with breakpoints on pc and watchpoints on memory and registers. Instructions go through the
+//debugger's own loop that checks after each one, none of the Core's dispatch loops know it exists. With nothing
+//set whole frames go through emulateFrame as normal, so attaching one costs nothing until it's used.
+//The Core has to be loaded, and shouldn't be run by anything else while a Debugger is attached
+class Debugger
+{
+public:
+    enum Stop
+    {
+        //Did the one instruction (or call) asked for
+        STOP_STEP,
+        //pc reached a breakpoint, the instruction there hasn't run
+        STOP_BREAKPOINT,
+        //An instruction changed a watched byte or register, it's already run
+        STOP_WATCHPOINT,
+        //Reached the frame asked for, the frame before it has finished
+        STOP_FRAME,
+        //The Core stopped, getStatus says why
+        STOP_HALTED
+    };
+
+    //Index for watchRegister, after V0 - VF
+    static const int registerI = 16;
+
+    Debugger (Core& core);
+
+    void setBreakpoint (unsigned short address, bool enabled = true);
+    bool isBreakpoint (unsigned short address) const { return (breakpoints[address >> 6] >> (address & 63)) & 1; }
+    void clearBreakpoints ();
+    void watchMemory (unsigned short address);
+    //0 - 15 for V0 - VF, registerI for I
+    void watchRegister (int index);
+    void clearWatchpoints ();
+
+    Stop step ();
+    //A CALL runs until it's returned, anything else is a step
+    Stop stepOver ();
+    //Frames since the Debugger was attached, where the next frame starts is frame
+    Stop runToFrame (long frame);
+    //Until something stops it
+    Stop run ();
+
+    long getFrame () const { return frame; }
+    //Instructions the current frame still has to run, 0 between frames
+    int getFrameRemaining () const { return inFrame ? remaining : 0; }
+    //What went off last time, "V3 05 -> 06"
+    const std::string& getWatchHit () const { return watchHit; }
+
+private:
+    Debugger (const Debugger&) = delete;
+    Debugger& operator= (const Debugger&) = delete;
+
+    //Runs until frame stopFrame starts or something stops it. stepping stops after the first instruction, or the
+    //first one that leaves the stack at or below returnDepth if that's 0 or more
+    Stop resume (long stopFrame, bool stepping, int returnDepth);
+    bool checkWatchpoints ();
+
+    Core& core;
+
+    uint64_t breakpoints [0x10000 / 64];
+    int breakpointCount;
+    //Address or register and the value it had after the last instruction
+    std::vector<std::pair<unsigned short, uint8_t>> memoryWatches;
+    std::vector<std::pair<int, uint16_t>> registerWatches;
+    std::string watchHit;
+
+    long frame;
+    //Partway through a frame - startFrame has been called and finishFrame hasn't
+    bool inFrame;
+    int remaining;
+    bool soundOn;
+};
+
+#endif /* defined(__Chip8__Debugger__) */
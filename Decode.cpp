@@ -0,0 +1,234 @@
+//
+//  Decode.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Decode.h"
+
+#include <string.h>
+
+//The SUPER-CHIP and XO-CHIP additions, OP_COUNT for anything that isn't one of them
+static Op decodeExtended (uint16_t opcode, Mode mode)
+{
+    bool xo = mode == MODE_XOCHIP;
+    uint8_t nn = opcode & 0xFF;
+
+    switch (opcode >> 12)
+    {
+        case 0x0:
+            if ((opcode & 0xFFF0) == 0x00C0)
+                return OP_SCD;
+            if ((opcode & 0xFFF0) == 0x00D0 && xo)
+                return OP_SCU;
+
+            switch (opcode)
+            {
+                case 0x00FB: return OP_SCR;
+                case 0x00FC: return OP_SCL;
+                case 0x00FD: return OP_EXIT;
+                case 0x00FE: return OP_LOW;
+                case 0x00FF: return OP_HIGH;
+            }
+            break;
+        case 0x5:
+            if ((opcode & 0xF) == 0x2 && xo)
+                return OP_SAVE_RANGE;
+            if ((opcode & 0xF) == 0x3 && xo)
+                return OP_LOAD_RANGE;
+            break;
+        case 0xF:
+            if (opcode == 0xF000 && xo)
+                return OP_LD_I_LONG;
+            if (opcode == 0xF002 && xo)
+                return OP_AUDIO;
+            if (nn == 0x01 && xo)
+                return OP_PLANE;
+            if (nn == 0x3A && xo)
+                return OP_PITCH;
+            if (nn == 0x30)
+                return OP_LD_HF;
+            if (nn == 0x75)
+                return OP_SAVE_FLAGS;
+            if (nn == 0x85)
+                return OP_LOAD_FLAGS;
+            break;
+    }
+
+    return OP_COUNT;
+}
+
+static Op decodeOp (uint16_t opcode, Mode mode)
+{
+    uint8_t nn = opcode & 0xFF;
+
+    if (mode != MODE_CHIP8)
+    {
+        Op op = decodeExtended(opcode, mode);
+
+        if (op != OP_COUNT)
+            return op;
+    }
+
+    //Most opcodes are based on the first character
+    switch (opcode >> 12)
+    {
+        case 0x0:
+            if (opcode == 0x00E0)
+                return OP_CLS;
+            if (opcode == 0x00EE)
+                return OP_RET;
+            return OP_SYS;
+        case 0x1:
+            return OP_JP;
+        case 0x2:
+            return OP_CALL;
+        case 0x3:
+            return OP_SE_BYTE;
+        case 0x4:
+            return OP_SNE_BYTE;
+        case 0x5:
+            return OP_SE_REG;
+        case 0x6:
+            return OP_LD_BYTE;
+        case 0x7:
+            return OP_ADD_BYTE;
+        case 0x8:
+            switch (opcode & 0xF)
+            {
+                case 0x0: return OP_LD_REG;
+                case 0x1: return OP_OR;
+                case 0x2: return OP_AND;
+                case 0x3: return OP_XOR;
+                case 0x4: return OP_ADD_REG;
+                case 0x5: return OP_SUB;
+                case 0x6: return OP_SHR;
+                case 0x7: return OP_SUBN;
+                case 0xE: return OP_SHL;
+                default: return OP_UNHANDLED;
+            }
+        case 0x9:
+            return OP_SNE_REG;
+        case 0xA:
+            return OP_LD_I;
+        case 0xB:
+            return OP_JP_V0;
+        case 0xC:
+            return OP_RND;
+        case 0xD:
+            return OP_DRW;
+        case 0xE:
+            if (nn == 0x9E)
+                return OP_SKP;
+            if (nn == 0xA1)
+                return OP_SKNP;
+            return OP_UNHANDLED;
+        case 0xF:
+            switch (nn)
+            {
+                case 0x07: return OP_LD_VX_DT;
+                case 0x0A: return OP_LD_VX_K;
+                case 0x15: return OP_LD_DT;
+                case 0x18: return OP_LD_ST;
+                case 0x1E: return OP_ADD_I;
+                case 0x29: return OP_LD_F;
+                case 0x33: return OP_LD_B;
+                case 0x55: return OP_LD_MEM;
+                case 0x65: return OP_LD_REGS;
+                default: return OP_UNHANDLED;
+            }
+    }
+
+    return OP_UNHANDLED;
+}
+
+Instruction decode (uint16_t opcode, Mode mode)
+{
+    Instruction instruction;
+
+    instruction.op = decodeOp(opcode, mode);
+    instruction.x = (opcode >> 8) & 0xF;
+    instruction.y = (opcode >> 4) & 0xF;
+    instruction.n = opcode & 0xF;
+    instruction.nn = opcode & 0xFF;
+    instruction.nnn = opcode & 0xFFF;
+
+    return instruction;
+}
+
+static Instruction* buildDecodeTable (Mode mode)
+{
+    Instruction* table = new Instruction [0x10000];
+
+    for (uint32_t opcode = 0; opcode < 0x10000; opcode++)
+        table[opcode] = decode(opcode, mode);
+
+    return table;
+}
+
+const Instruction* getDecodeTable (Mode mode)
+{
+    //Static init is thread safe, so Cores on different threads can all ask for them. Each is only built the first
+    //time its mode is used
+    switch (mode)
+    {
+        case MODE_SCHIP:
+        {
+            static const Instruction* table = buildDecodeTable(MODE_SCHIP);
+            return table;
+        }
+        case MODE_XOCHIP:
+        {
+            static const Instruction* table = buildDecodeTable(MODE_XOCHIP);
+            return table;
+        }
+        default:
+        {
+            static const Instruction* table = buildDecodeTable(MODE_CHIP8);
+            return table;
+        }
+    }
+}
+
+const char* getOpName (Op op)
+{
+    //Must be in the same order as Op
+    static const char* const names [OP_COUNT] = {
+        "SYS 0NNN", "CLS 00E0", "RET 00EE", "JP 1NNN", "CALL 2NNN",
+        "SE 3XNN", "SNE 4XNN", "SE 5XY0", "LD 6XNN", "ADD 7XNN",
+        "LD 8XY0", "OR 8XY1", "AND 8XY2", "XOR 8XY3", "ADD 8XY4",
+        "SUB 8XY5", "SHR 8XY6", "SUBN 8XY7", "SHL 8XYE", "SNE 9XY0",
+        "LD ANNN", "JP BNNN", "RND CXNN", "DRW DXYN", "SKP EX9E", "SKNP EXA1",
+        "LD FX07", "LD FX0A", "LD FX15", "LD FX18", "ADD FX1E",
+        "LD FX29", "LD FX33", "LD FX55", "LD FX65",
+        "SCD 00CN", "SCR 00FB", "SCL 00FC", "EXIT 00FD", "LOW 00FE", "HIGH 00FF",
+        "LD FX30", "LD FX75", "LD FX85",
+        "SCU 00DN", "SAVE 5XY2", "LOAD 5XY3", "LD F000", "PLANE FN01", "AUDIO F002", "PITCH FX3A",
+        "UNHANDLED"
+    };
+
+    return op < OP_COUNT ? names[op] : "?";
+}
+
+const char* getModeName (Mode mode)
+{
+    static const char* const names [MODE_COUNT] = { "chip8", "schip", "xochip" };
+
+    return mode < MODE_COUNT ? names[mode] : "?";
+}
+
+bool parseMode (const char* name, Mode& mode)
+{
+    for (int i = 0; i < MODE_COUNT; i++)
+    {
+        if (strcmp(name, getModeName((Mode) i)) == 0)
+        {
+            mode = (Mode) i;
+            return true;
+        }
+    }
+
+    return false;
+}
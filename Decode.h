@@ -0,0 +1,110 @@
+//
+//  Decode.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Decode__
+#define __Chip8__Decode__
+
+#include <stdint.h>
+
+//Which machine the opcodes are for. Each has its own decode table, so an extension opcode in a mode that doesn't have
+//it decodes exactly as plain CHIP-8 did
+enum Mode : uint8_t
+{
+    MODE_CHIP8,
+    //SUPER-CHIP 1.1 - 128x64, scrolling, 16x16 sprites, big font, RPL flags
+    MODE_SCHIP,
+    //XO-CHIP - SUPER-CHIP plus 64K of memory, two bit planes and the audio pattern
+    MODE_XOCHIP,
+    MODE_COUNT
+};
+
+//Every instruction the interpreter knows about, one handler each
+enum Op : uint8_t
+{
+    OP_SYS,         //0NNN
+    OP_CLS,         //00E0
+    OP_RET,         //00EE
+    OP_JP,          //1NNN
+    OP_CALL,        //2NNN
+    OP_SE_BYTE,     //3XNN
+    OP_SNE_BYTE,    //4XNN
+    OP_SE_REG,      //5XY0
+    OP_LD_BYTE,     //6XNN
+    OP_ADD_BYTE,    //7XNN
+    OP_LD_REG,      //8XY0
+    OP_OR,          //8XY1
+    OP_AND,         //8XY2
+    OP_XOR,         //8XY3
+    OP_ADD_REG,     //8XY4
+    OP_SUB,         //8XY5
+    OP_SHR,         //8XY6
+    OP_SUBN,        //8XY7
+    OP_SHL,         //8XYE
+    OP_SNE_REG,     //9XY0
+    OP_LD_I,        //ANNN
+    OP_JP_V0,       //BNNN
+    OP_RND,         //CXNN
+    OP_DRW,         //DXYN
+    OP_SKP,         //EX9E
+    OP_SKNP,        //EXA1
+    OP_LD_VX_DT,    //FX07
+    OP_LD_VX_K,     //FX0A
+    OP_LD_DT,       //FX15
+    OP_LD_ST,       //FX18
+    OP_ADD_I,       //FX1E
+    OP_LD_F,        //FX29
+    OP_LD_B,        //FX33
+    OP_LD_MEM,      //FX55
+    OP_LD_REGS,     //FX65
+    //SUPER-CHIP
+    OP_SCD,         //00CN
+    OP_SCR,         //00FB
+    OP_SCL,         //00FC
+    OP_EXIT,        //00FD
+    OP_LOW,         //00FE
+    OP_HIGH,        //00FF
+    OP_LD_HF,       //FX30
+    OP_SAVE_FLAGS,  //FX75
+    OP_LOAD_FLAGS,  //FX85
+    //XO-CHIP
+    OP_SCU,         //00DN
+    OP_SAVE_RANGE,  //5XY2
+    OP_LOAD_RANGE,  //5XY3
+    OP_LD_I_LONG,   //F000 NNNN
+    OP_PLANE,       //FN01
+    OP_AUDIO,       //F002
+    OP_PITCH,       //FX3A
+    OP_UNHANDLED,
+
+    OP_COUNT
+};
+
+//An opcode with all of its fields already pulled out
+struct Instruction
+{
+    Op op;
+    //Register indexes (0x0F00 and 0x00F0)
+    uint8_t x;
+    uint8_t y;
+    //Last nibble and last byte
+    uint8_t n;
+    uint8_t nn;
+    //Address
+    uint16_t nnn;
+};
+
+//Table of all 64K opcodes for a mode, built on first use and shared by every Core
+const Instruction* getDecodeTable (Mode mode = MODE_CHIP8);
+Instruction decode (uint16_t opcode, Mode mode = MODE_CHIP8);
+//Short name with the opcode pattern, "CALL 2NNN"
+const char* getOpName (Op op);
+//"chip8", "schip" or "xochip", and back. parseMode returns false for anything else
+const char* getModeName (Mode mode);
+bool parseMode (const char* name, Mode& mode);
+
+#endif /* defined(__Chip8__Decode__) */
@@ -0,0 +1,289 @@
+//
+//  Differential.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Differential.h"
+#include "Hash.h"
+
+#include <string.h>
+#include <type_traits>
+
+using namespace std;
+
+//Bytes of memory listed before the rest are only counted
+static const int memoryListed = 8;
+
+static uint64_t mix(uint64_t hash, uint64_t value)
+{
+    return (hash ^ value) * fnv1aPrime;
+}
+
+template <typename Reference>
+Differential<Reference>::Differential(Dispatch candidateDispatch)
+{
+    candidate.setDispatch(candidateDispatch);
+
+    //The ReferenceCore runs every instruction and never halts on a loop, so the candidate has to as well
+    if (is_same<Reference, ReferenceCore>::value)
+        candidate.setIdleSkip(false);
+
+    frame = 0;
+    checkpointInterval = 60;
+    referenceTrace = 0;
+    candidateTrace = 0;
+    checkpointFrame = 0;
+
+    referenceCheckpoint = unique_ptr<Snapshot>(new Snapshot);
+    candidateCheckpoint = unique_ptr<Snapshot>(new Snapshot);
+    referenceState = unique_ptr<Snapshot>(new Snapshot);
+    candidateState = unique_ptr<Snapshot>(new Snapshot);
+}
+
+template <typename Reference>
+template <typename Machine>
+uint64_t Differential<Reference>::hashFrame(const Machine& machine)
+{
+    uint64_t hash = machine.hashDisplay();
+    const unsigned char* registers = machine.getRegisters();
+
+    for (int i = 0; i < 16; i++)
+        hash = mix(hash, registers[i]);
+
+    hash = mix(hash, machine.getI());
+    hash = mix(hash, machine.getPC());
+    hash = mix(hash, machine.getDelayTimer());
+    hash = mix(hash, machine.getSoundTimer());
+    hash = mix(hash, machine.getStatus());
+    hash = mix(hash, machine.getCycles());
+
+    return hash;
+}
+
+template <typename Reference>
+bool Differential<Reference>::sameState()
+{
+    //saveState zeroes the padding, so the whole blob can be compared
+    reference.saveState(*referenceState);
+    candidate.saveState(*candidateState);
+
+    return memcmp(referenceState.get(), candidateState.get(), sizeof(Snapshot)) == 0;
+}
+
+template <typename Reference>
+bool Differential<Reference>::run(long frames)
+{
+    frame = 0;
+    referenceTrace = fnv1aBasis;
+    candidateTrace = referenceTrace;
+    divergence.reset();
+
+    //Set up differently, nothing to replay
+    if (!sameState())
+    {
+        divergence = unique_ptr<Divergence>(new Divergence);
+        divergence->frame = 0;
+        divergence->instruction = -1;
+        divergence->address = reference.getPC();
+        divergence->opcode = 0;
+        divergence->reference = *referenceState;
+        divergence->candidate = *candidateState;
+        return false;
+    }
+
+    swap(referenceState, referenceCheckpoint);
+    swap(candidateState, candidateCheckpoint);
+    checkpointFrame = 0;
+
+    while (frame < frames && reference.getStatus() == STATUS_RUNNING)
+    {
+        reference.emulateFrame();
+        candidate.emulateFrame();
+        frame++;
+
+        referenceTrace = mix(referenceTrace, hashFrame(reference));
+        candidateTrace = mix(candidateTrace, hashFrame(candidate));
+
+        //Memory only gets looked at here, so the last frame is always a checkpoint
+        bool checkpoint = frame - checkpointFrame >= checkpointInterval || frame == frames || reference.getStatus() != STATUS_RUNNING;
+
+        if (referenceTrace != candidateTrace || (checkpoint && !sameState()))
+        {
+            locate();
+            return false;
+        }
+
+        if (checkpoint)
+        {
+            swap(referenceState, referenceCheckpoint);
+            swap(candidateState, candidateCheckpoint);
+            checkpointFrame = frame;
+        }
+    }
+
+    return true;
+}
+
+template <typename Reference>
+void Differential<Reference>::locate()
+{
+    divergence = unique_ptr<Divergence>(new Divergence);
+    Divergence& found = *divergence;
+
+    reference.loadState(*referenceCheckpoint);
+    candidate.loadState(*candidateCheckpoint);
+
+    for (long replayed = checkpointFrame; replayed < frame; replayed++)
+    {
+        //The checkpoint's been loaded, so its space can hold where each frame starts
+        reference.saveState(*referenceCheckpoint);
+        candidate.saveState(*candidateCheckpoint);
+
+        unsigned short frameStart = reference.getPC();
+
+        reference.emulateFrame();
+        candidate.emulateFrame();
+
+        if (sameState())
+            continue;
+
+        found.frame = replayed + 1;
+        found.instruction = -1;
+        found.address = frameStart;
+        found.opcode = 0;
+
+        //Same frame again an instruction at a time. Within a frame nothing but the instructions moves, the
+        //timers and Fx0A's key are only looked at either side of them
+        uint64_t frameEnd = reference.getCycles();
+
+        reference.loadState(*referenceCheckpoint);
+        candidate.loadState(*candidateCheckpoint);
+
+        for (long instruction = 0; reference.getCycles() < frameEnd && reference.getStatus() == STATUS_RUNNING && !reference.isWaitingForKey(); instruction++)
+        {
+            //Before it runs, it might write over itself
+            const unsigned char* memory = reference.getMemory();
+            size_t mask = reference.getMemorySize() - 1;
+            unsigned short address = reference.getPC();
+            unsigned short opcode = (memory[address & mask] << 8) | memory[(address + 1) & mask];
+
+            reference.emulateCycles(1);
+            candidate.emulateCycles(1);
+
+            if (!sameState())
+            {
+                found.instruction = instruction;
+                found.address = address;
+                found.opcode = opcode;
+                found.reference = *referenceState;
+                found.candidate = *candidateState;
+                return;
+            }
+        }
+
+        //Every instruction agreed, it's the frame around them
+        reference.loadState(*referenceCheckpoint);
+        candidate.loadState(*candidateCheckpoint);
+        reference.emulateFrame();
+        candidate.emulateFrame();
+        sameState();
+
+        found.reference = *referenceState;
+        found.candidate = *candidateState;
+        return;
+    }
+
+    //Replaying didn't do it again, something isn't deterministic. Report what run saw
+    sameState();
+
+    found.frame = frame;
+    found.instruction = -1;
+    found.address = reference.getPC();
+    found.opcode = 0;
+    found.reference = *referenceState;
+    found.candidate = *candidateState;
+}
+
+template class Differential<Core>;
+template class Differential<ReferenceCore>;
+
+static void printValue(FILE* out, const char* name, unsigned long long reference, unsigned long long candidate)
+{
+    if (reference != candidate)
+        fprintf(out, "    %-18s reference %llx, candidate %llx\n", name, reference, candidate);
+}
+
+template <typename T>
+static void printArray(FILE* out, const char* name, const T* reference, const T* candidate, int count)
+{
+    char label [32];
+
+    for (int i = 0; i < count; i++)
+    {
+        snprintf(label, sizeof(label), "%s[%x]", name, i);
+        printValue(out, label, reference[i], candidate[i]);
+    }
+}
+
+void printDifferences(FILE* out, const Snapshot& reference, const Snapshot& candidate)
+{
+    printArray(out, "V", reference.registers, candidate.registers, 16);
+    printValue(out, "I", reference.I, candidate.I);
+    printValue(out, "pc", reference.pc, candidate.pc);
+    printValue(out, "sp", reference.sp, candidate.sp);
+    printArray(out, "stack", reference.stack, candidate.stack, 16);
+    printValue(out, "dt", reference.dt, candidate.dt);
+    printValue(out, "st", reference.st, candidate.st);
+    printValue(out, "status", reference.status, candidate.status);
+    printValue(out, "unhandledOpcode", reference.unhandledOpcode, candidate.unhandledOpcode);
+    printValue(out, "waitingForKey", reference.waitingForKey, candidate.waitingForKey);
+    printValue(out, "keyRegister", reference.keyRegister, candidate.keyRegister);
+    printValue(out, "mode", reference.mode, candidate.mode);
+    printValue(out, "hires", reference.hires, candidate.hires);
+    printValue(out, "planeMask", reference.planeMask, candidate.planeMask);
+    printValue(out, "pitch", reference.pitch, candidate.pitch);
+    printValue(out, "quirks", reference.quirks, candidate.quirks);
+    printArray(out, "flags", reference.flags, candidate.flags, 16);
+    printArray(out, "pattern", reference.pattern, candidate.pattern, 16);
+    printValue(out, "randomState", reference.randomState, candidate.randomState);
+    printValue(out, "cycles", reference.cycles, candidate.cycles);
+    printValue(out, "instructionCredit", reference.instructionCredit, candidate.instructionCredit);
+
+    int listed = 0;
+    int differing = 0;
+
+    for (size_t address = 0; address < sizeof(reference.memory); address++)
+    {
+        if (reference.memory[address] == candidate.memory[address])
+            continue;
+
+        if (listed++ < memoryListed)
+            fprintf(out, "    memory[%04zx]       reference %02x, candidate %02x\n", address, reference.memory[address], candidate.memory[address]);
+
+        differing++;
+    }
+
+    if (differing > memoryListed)
+        fprintf(out, "    ...and %d more bytes of memory\n", differing - memoryListed);
+
+    //Whole words, each is 64 pixels of a row
+    int firstWord = -1;
+    differing = 0;
+
+    for (int word = 0; word < (int) (sizeof(reference.display) / sizeof(reference.display[0])); word++)
+    {
+        if (reference.display[word] == candidate.display[word])
+            continue;
+
+        if (firstWord < 0)
+            firstWord = word;
+
+        differing++;
+    }
+
+    if (differing > 0)
+        fprintf(out, "    display            %d words differ, the first is word %d\n", differing, firstWord);
+}
@@ -0,0 +1,102 @@
+//
+//  Differential.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Differential__
+#define __Chip8__Differential__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <memory>
+
+#include "Core.h"
+#include "ReferenceCore.h"
+#include "Snapshot.h"
+
+//Where two machines running the same ROM first stopped agreeing
+struct Divergence
+{
+    long frame;
+    //Instructions into the frame, -1 if every instruction agreed and it was the frame's own work (timers, Fx0A,
+    //idle skipping) that split them
+    long instruction;
+    //The instruction that did it
+    unsigned short address;
+    unsigned short opcode;
+    //Both machines straight after it
+    Snapshot reference;
+    Snapshot candidate;
+};
+
+//Runs a ROM on a reference machine and on a candidate Core, the same way whatever the reference is:
+//  - Core as the reference runs the plain handler table against another dispatch. The two share every handler, so
+//    this checks the dispatch (threading, the recompiler's blocks and native code, idle skipping) and nothing else
+//  - ReferenceCore as the reference checks the table Core's handlers themselves against an interpreter that has
+//    none of their code. Idle skipping is off on the candidate, the ReferenceCore never skips or halts on a loop
+//Every frame the registers, I, pc, timers and display go into a rolling hash for each, the whole machine memory
+//included is compared at checkpoints. When the hashes disagree both go back to the last checkpoint and replay up
+//to the frame it happened in one instruction at a time, so what's reported is the first instruction that differs
+template <typename Reference>
+class Differential
+{
+public:
+    Differential (Dispatch candidateDispatch);
+
+    //Anything that has to be the same on both machines (mode, quirks, rates, Input, the ROM) goes through here.
+    //apply gets the reference and then the candidate, so it has to take both - a generic lambda does
+    template <typename Apply>
+    void setup (const Apply& apply)
+    {
+        apply(reference);
+        apply(candidate);
+    }
+    //Frames between full comparisons and restore points, more costs less but means more replaying to find the
+    //instruction when they disagree
+    void setCheckpointInterval (long frames) { checkpointInterval = frames > 0 ? frames : 1; }
+
+    //Runs until frames have run, the reference stops, or the two disagree. Returns false if they disagreed
+    bool run (long frames);
+
+    long getFrames () const { return frame; }
+    //Hash of every frame so far on the reference, same for the same ROM and settings from one build to the next
+    uint64_t getTraceHash () const { return referenceTrace; }
+    //nullptr until run has returned false
+    const Divergence* getDivergence () const { return divergence.get(); }
+
+    const Reference& getReference () const { return reference; }
+    const Core& getCandidate () const { return candidate; }
+
+private:
+    //What the rolling hash takes from a frame, only what's cheap to get at
+    template <typename Machine>
+    static uint64_t hashFrame (const Machine& machine);
+    bool sameState ();
+    //Goes back to the checkpoint and finds the first instruction after it that differs
+    void locate ();
+
+    Reference reference;
+    Core candidate;
+
+    long frame;
+    long checkpointInterval;
+    uint64_t referenceTrace;
+    uint64_t candidateTrace;
+
+    //Both machines at checkpointFrame. Two of these are 140K, so they and the scratch pair live on the heap
+    long checkpointFrame;
+    std::unique_ptr<Snapshot> referenceCheckpoint;
+    std::unique_ptr<Snapshot> candidateCheckpoint;
+    std::unique_ptr<Snapshot> referenceState;
+    std::unique_ptr<Snapshot> candidateState;
+
+    std::unique_ptr<Divergence> divergence;
+};
+
+//Field by field list of what's different between two snapshots
+void printDifferences (FILE* out, const Snapshot& reference, const Snapshot& candidate);
+
+#endif /* defined(__Chip8__Differential__) */
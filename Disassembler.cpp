@@ -0,0 +1,106 @@
+//
+//  Disassembler.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Disassembler.h"
+
+int disassemble(const unsigned char* memory, size_t memorySize, unsigned short address, Mode mode, char* text, size_t textSize)
+{
+    size_t mask = memorySize - 1;
+    unsigned short opcode = (memory[address & mask] << 8) | memory[(address + 1) & mask];
+    //Shared with the interpreter, so what's listed is exactly what would run
+    const Instruction& instruction = getDecodeTable(mode)[opcode];
+    int x = instruction.x;
+    int y = instruction.y;
+
+    switch (instruction.op)
+    {
+        case OP_SYS:        snprintf(text, textSize, "SYS 0x%03X", instruction.nnn); break;
+        case OP_CLS:        snprintf(text, textSize, "CLS"); break;
+        case OP_RET:        snprintf(text, textSize, "RET"); break;
+        case OP_JP:         snprintf(text, textSize, "JP 0x%03X", instruction.nnn); break;
+        case OP_CALL:       snprintf(text, textSize, "CALL 0x%03X", instruction.nnn); break;
+        case OP_SE_BYTE:    snprintf(text, textSize, "SE V%X, 0x%02X", x, instruction.nn); break;
+        case OP_SNE_BYTE:   snprintf(text, textSize, "SNE V%X, 0x%02X", x, instruction.nn); break;
+        case OP_SE_REG:     snprintf(text, textSize, "SE V%X, V%X", x, y); break;
+        case OP_LD_BYTE:    snprintf(text, textSize, "LD V%X, 0x%02X", x, instruction.nn); break;
+        case OP_ADD_BYTE:   snprintf(text, textSize, "ADD V%X, 0x%02X", x, instruction.nn); break;
+        case OP_LD_REG:     snprintf(text, textSize, "LD V%X, V%X", x, y); break;
+        case OP_OR:         snprintf(text, textSize, "OR V%X, V%X", x, y); break;
+        case OP_AND:        snprintf(text, textSize, "AND V%X, V%X", x, y); break;
+        case OP_XOR:        snprintf(text, textSize, "XOR V%X, V%X", x, y); break;
+        case OP_ADD_REG:    snprintf(text, textSize, "ADD V%X, V%X", x, y); break;
+        case OP_SUB:        snprintf(text, textSize, "SUB V%X, V%X", x, y); break;
+        case OP_SHR:        snprintf(text, textSize, "SHR V%X, V%X", x, y); break;
+        case OP_SUBN:       snprintf(text, textSize, "SUBN V%X, V%X", x, y); break;
+        case OP_SHL:        snprintf(text, textSize, "SHL V%X, V%X", x, y); break;
+        case OP_SNE_REG:    snprintf(text, textSize, "SNE V%X, V%X", x, y); break;
+        case OP_LD_I:       snprintf(text, textSize, "LD I, 0x%03X", instruction.nnn); break;
+        case OP_JP_V0:      snprintf(text, textSize, "JP V0, 0x%03X", instruction.nnn); break;
+        case OP_RND:        snprintf(text, textSize, "RND V%X, 0x%02X", x, instruction.nn); break;
+        case OP_DRW:        snprintf(text, textSize, "DRW V%X, V%X, %d", x, y, instruction.n); break;
+        case OP_SKP:        snprintf(text, textSize, "SKP V%X", x); break;
+        case OP_SKNP:       snprintf(text, textSize, "SKNP V%X", x); break;
+        case OP_LD_VX_DT:   snprintf(text, textSize, "LD V%X, DT", x); break;
+        case OP_LD_VX_K:    snprintf(text, textSize, "LD V%X, K", x); break;
+        case OP_LD_DT:      snprintf(text, textSize, "LD DT, V%X", x); break;
+        case OP_LD_ST:      snprintf(text, textSize, "LD ST, V%X", x); break;
+        case OP_ADD_I:      snprintf(text, textSize, "ADD I, V%X", x); break;
+        case OP_LD_F:       snprintf(text, textSize, "LD F, V%X", x); break;
+        case OP_LD_B:       snprintf(text, textSize, "LD B, V%X", x); break;
+        case OP_LD_MEM:     snprintf(text, textSize, "LD [I], V%X", x); break;
+        case OP_LD_REGS:    snprintf(text, textSize, "LD V%X, [I]", x); break;
+        case OP_SCD:        snprintf(text, textSize, "SCD %d", instruction.n); break;
+        case OP_SCR:        snprintf(text, textSize, "SCR"); break;
+        case OP_SCL:        snprintf(text, textSize, "SCL"); break;
+        case OP_EXIT:       snprintf(text, textSize, "EXIT"); break;
+        case OP_LOW:        snprintf(text, textSize, "LOW"); break;
+        case OP_HIGH:       snprintf(text, textSize, "HIGH"); break;
+        case OP_LD_HF:      snprintf(text, textSize, "LD HF, V%X", x); break;
+        case OP_SAVE_FLAGS: snprintf(text, textSize, "LD R, V%X", x); break;
+        case OP_LOAD_FLAGS: snprintf(text, textSize, "LD V%X, R", x); break;
+        case OP_SCU:        snprintf(text, textSize, "SCU %d", instruction.n); break;
+        case OP_SAVE_RANGE: snprintf(text, textSize, "SAVE V%X - V%X", x, y); break;
+        case OP_LOAD_RANGE: snprintf(text, textSize, "LOAD V%X - V%X", x, y); break;
+        case OP_PLANE:      snprintf(text, textSize, "PLANE %d", x); break;
+        case OP_AUDIO:      snprintf(text, textSize, "AUDIO"); break;
+        case OP_PITCH:      snprintf(text, textSize, "PITCH V%X", x); break;
+        case OP_LD_I_LONG:
+            snprintf(text, textSize, "LD I, 0x%04X", (memory[(address + 2) & mask] << 8) | memory[(address + 3) & mask]);
+            return 4;
+        default:
+            //Data, or something nothing runs
+            snprintf(text, textSize, "DW 0x%04X", opcode);
+            break;
+    }
+
+    return 2;
+}
+
+void disassembleRange(FILE* out, const unsigned char* memory, size_t memorySize, unsigned short start, unsigned short end, Mode mode)
+{
+    size_t mask = memorySize - 1;
+    char text [32];
+    //Counted rather than compared, so a range that runs up to the top of memory doesn't wrap round forever
+    size_t length = (size_t) (end - start) & mask;
+    size_t position = 0;
+
+    while (position < length)
+    {
+        unsigned short address = (start + position) & mask;
+        int size = disassemble(memory, memorySize, address, mode, text, sizeof(text));
+
+        fprintf(out, "%04X  %02X%02X", address, memory[address], memory[(address + 1) & mask]);
+
+        if (size == 4)
+            fprintf(out, "%02X%02X   %s\n", memory[(address + 2) & mask], memory[(address + 3) & mask], text);
+        else
+            fprintf(out, "       %s\n", text);
+
+        position += size;
+    }
+}
@@ -0,0 +1,26 @@
+//
+//  Disassembler.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Disassembler__
+#define __Chip8__Disassembler__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Decode.h"
+
+//Assembly for the instruction at address in Cowgod's mnemonics, "LD V3, 0x12". Only reads memory, which wraps at
+//memorySize (a power of two). Returns how many bytes the instruction takes, 4 for XO-CHIP's F000 NNNN and 2 for
+//everything else
+int disassemble (const unsigned char* memory, size_t memorySize, unsigned short address, Mode mode, char* text, size_t textSize);
+
+//Every instruction from start up to end, one per line as "0200  6005       LD V0, 0x05"
+void disassembleRange (FILE* out, const unsigned char* memory, size_t memorySize, unsigned short start, unsigned short end, Mode mode);
+
+#endif /* defined(__Chip8__Disassembler__) */
@@ -0,0 +1,22 @@
+//
+//  Font.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Font__
+#define __Chip8__Font__
+
+//Built in sprites every machine copies into interpreter memory on reset, shared so a Core and a ReferenceCore
+//start from the same bytes
+
+//0-F, 5 bytes each from address 0, Fx29 points I at them
+extern const unsigned char smallFont [16 * 5];
+//SUPER-CHIP 8x10 digits, Fx30 points I at them. Only the later modes have them, plain CHIP-8 programs can have
+//anything they like at 0x50
+static const int bigFontStart = 0x50;
+extern const unsigned char bigFont [16 * 10];
+
+#endif /* defined(__Chip8__Font__) */
@@ -0,0 +1,68 @@
+//
+//  Frontend.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Frontend__
+#define __Chip8__Frontend__
+
+#include <stdint.h>
+
+//Interfaces the headless Core talks to. None of them are required - a Core with no frontends attached
+//runs as fast as possible with no keys pressed and nothing drawn
+
+class Input
+{
+public:
+    virtual ~Input() {}
+
+    //Called once per frame before any cycles run, returns false if the host wants emulation to stop
+    virtual bool pollEvents () = 0;
+    //Chip8 key (0x0 - 0xF) is currently held down
+    virtual bool isKeyDown (unsigned char key) = 0;
+    //Fx0A - a Chip8 key pressed since the last pollEvents, or -1. Never blocks, a Core waiting on Fx0A asks
+    //again every frame
+    virtual int getKeyPress () = 0;
+};
+
+class Video
+{
+public:
+    virtual ~Video() {}
+
+    //display is height rows of width / 64 words, a bit per pixel with bit 63 of a row's first word at x = 0,
+    //then the same again for each plane after the first. A pixel's colour is its bit from every plane
+    //Only called when something changed, bit n of dirtyRows set means row n did in some plane
+    virtual void render (const uint64_t* display, int width, int height, int planes, uint64_t dirtyRows) = 0;
+};
+
+class Audio
+{
+public:
+    virtual ~Audio() {}
+
+    //Once per timer tick. The sound timer was running at the start of the tick if startsOn and flipped at each
+    //edge, given in order as how far through the tick's instructions it happened (0 - 1)
+    virtual void tick (bool startsOn, const float* edges, int edgeCount) = 0;
+    //XO-CHIP F002 and Fx3A - the 16 byte, 1 bit sample pattern the tone plays and the rate it plays at
+    virtual void setPattern (const uint8_t* pattern) {}
+    virtual void setPitch (uint8_t pitch) {}
+};
+
+class Timer
+{
+public:
+    virtual ~Timer() {}
+
+    //Nanoseconds since some fixed point, from a steady high resolution clock
+    virtual uint64_t getTime () = 0;
+    //Around this long, can be coarse - Pacer spins out whatever's left
+    virtual void sleep (uint64_t nanoseconds) = 0;
+    //When the display last refreshed, on the getTime clock. 0 if it isn't known
+    virtual uint64_t getLastVsync () { return 0; }
+};
+
+#endif /* defined(__Chip8__Frontend__) */
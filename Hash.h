@@ -0,0 +1,31 @@
+//
+//  Hash.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Hash__
+#define __Chip8__Hash__
+
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint64_t fnv1aBasis = 0xcbf29ce484222325ull;
+static const uint64_t fnv1aPrime = 0x100000001b3ull;
+
+//64 bit FNV-1a, what ROMs, memory, displays and snapshots are all hashed with. Pass the last result back in as
+//seed to carry on over something that isn't in one piece
+inline uint64_t fnv1a (const void* data, size_t size, uint64_t seed = fnv1aBasis)
+{
+    const unsigned char* bytes = (const unsigned char*) data;
+    uint64_t hash = seed;
+
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * fnv1aPrime;
+
+    return hash;
+}
+
+#endif /* defined(__Chip8__Hash__) */
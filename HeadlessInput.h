@@ -0,0 +1,29 @@
+//
+//  HeadlessInput.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__HeadlessInput__
+#define __Chip8__HeadlessInput__
+
+#include "Frontend.h"
+
+//No keyboard, for the tools that run ROMs without a window - nothing is ever held, but Fx0A can be given the same
+//key every time it asks to get past menus. -1 leaves it waiting
+class AutoKeyInput : public Input
+{
+public:
+    AutoKeyInput (int key) : key(key) {}
+
+    bool pollEvents () override { return true; }
+    bool isKeyDown (unsigned char) override { return false; }
+    int getKeyPress () override { return key; }
+
+private:
+    int key;
+};
+
+#endif /* defined(__Chip8__HeadlessInput__) */
@@ -0,0 +1,386 @@
+//
+//  InputLog.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "InputLog.h"
+#include "Hash.h"
+
+using namespace std;
+
+static const uint32_t logMagic = 0x4E493843;     //"C8IN"
+static const uint32_t logVersion = 1;
+
+//Little endian fixed width and LEB128 varints, frames are stored as the gap since the entry before
+static void put(vector<uint8_t>& out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out.push_back((uint8_t) (value >> (i * 8)));
+}
+
+static void putVarint(vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((uint8_t) (value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back((uint8_t) value);
+}
+
+struct Reader
+{
+    const vector<uint8_t>& data;
+    size_t position;
+    bool failed;
+
+    uint64_t get (int bytes)
+    {
+        uint64_t value = 0;
+
+        if (position + bytes > data.size())
+        {
+            failed = true;
+            return 0;
+        }
+
+        for (int i = 0; i < bytes; i++)
+            value |= (uint64_t) data[position++] << (i * 8);
+
+        return value;
+    }
+
+    uint64_t getVarint ()
+    {
+        uint64_t value = 0;
+
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t byte = (uint8_t) get(1);
+            value |= (uint64_t) (byte & 0x7F) << shift;
+
+            if ((byte & 0x80) == 0 || failed)
+                return value;
+        }
+
+        failed = true;
+        return 0;
+    }
+};
+
+InputLog::InputLog()
+{
+    seed = 0;
+    instructionRate = 0;
+    timerRate = 0;
+    memoryHash = 0;
+    mode = MODE_CHIP8;
+    quirks = 0;
+    frames = 0;
+}
+
+void InputLog::begin(const Core& core)
+{
+    seed = core.getRandomState();
+    instructionRate = core.getInstructionRate();
+    timerRate = core.getTimerRate();
+    memoryHash = fnv1a(core.getMemory(), core.getMemorySize());
+    mode = core.getMode();
+    quirks = core.getQuirks();
+    frames = 0;
+
+    keyChanges.clear();
+    keyPresses.clear();
+    displayHashes.clear();
+}
+
+bool InputLog::apply(Core& core) const
+{
+    if (core.getMode() != mode || fnv1a(core.getMemory(), core.getMemorySize()) != memoryHash)
+        return false;
+
+    core.seed(seed);
+    core.setQuirks(quirks);
+    core.setInstructionRate(instructionRate);
+    core.setTimerRate(timerRate);
+
+    return true;
+}
+
+bool InputLog::save(const char* location) const
+{
+    vector<uint8_t> out;
+
+    put(out, logMagic, 4);
+    put(out, logVersion, 4);
+    put(out, seed, 4);
+    put(out, instructionRate, 4);
+    put(out, timerRate, 4);
+    put(out, frames, 4);
+    put(out, memoryHash, 8);
+    put(out, mode, 1);
+    put(out, quirks, 1);
+
+    uint32_t last = 0;
+    putVarint(out, keyChanges.size());
+
+    for (const KeyChange& change : keyChanges)
+    {
+        putVarint(out, change.frame - last);
+        put(out, change.keys, 2);
+        last = change.frame;
+    }
+
+    last = 0;
+    putVarint(out, keyPresses.size());
+
+    for (const KeyPress& press : keyPresses)
+    {
+        putVarint(out, press.frame - last);
+        putVarint(out, press.call);
+        put(out, press.key, 1);
+        last = press.frame;
+    }
+
+    last = 0;
+    putVarint(out, displayHashes.size());
+
+    for (const DisplayHash& display : displayHashes)
+    {
+        putVarint(out, display.frame - last);
+        put(out, display.hash, 8);
+        last = display.frame;
+    }
+
+    FILE* file = fopen(location, "wb");
+
+    if (file == nullptr)
+        return false;
+
+    bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+
+    return fclose(file) == 0 && written;
+}
+
+bool InputLog::load(const char* location)
+{
+    FILE* file = fopen(location, "rb");
+
+    if (file == nullptr)
+        return false;
+
+    vector<uint8_t> data;
+    uint8_t buffer [4096];
+    size_t count;
+
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + count);
+
+    fclose(file);
+
+    Reader in = {data, 0, false};
+
+    if (in.get(4) != logMagic)
+        return false;
+
+    if (in.get(4) != logVersion)
+        return false;
+
+    seed = (uint32_t) in.get(4);
+    instructionRate = (int) in.get(4);
+    timerRate = (int) in.get(4);
+    frames = (uint32_t) in.get(4);
+    memoryHash = in.get(8);
+    mode = (Mode) in.get(1);
+    quirks = (uint8_t) in.get(1);
+
+    keyChanges.resize(in.failed ? 0 : in.getVarint());
+    uint32_t last = 0;
+
+    for (size_t i = 0; i < keyChanges.size() && !in.failed; i++)
+    {
+        last += (uint32_t) in.getVarint();
+        keyChanges[i] = {last, (uint16_t) in.get(2)};
+    }
+
+    keyPresses.resize(in.failed ? 0 : in.getVarint());
+    last = 0;
+
+    for (size_t i = 0; i < keyPresses.size() && !in.failed; i++)
+    {
+        last += (uint32_t) in.getVarint();
+        uint32_t call = (uint32_t) in.getVarint();
+        keyPresses[i] = {last, call, (int) in.get(1) & 0xF};
+    }
+
+    displayHashes.resize(in.failed ? 0 : in.getVarint());
+    last = 0;
+
+    for (size_t i = 0; i < displayHashes.size() && !in.failed; i++)
+    {
+        last += (uint32_t) in.getVarint();
+        displayHashes[i] = {last, in.get(8)};
+    }
+
+    return !in.failed && timerRate > 0 && mode < MODE_COUNT && quirks < quirkCombinations;
+}
+
+InputRecorder::InputRecorder(Input& source, const Core& core, InputLog& log) : source(source), core(core), log(log)
+{
+    frame = 0;
+    keyPressCalls = 0;
+    keys = 0;
+    lastHash = core.hashDisplay();
+}
+
+void InputRecorder::recordDisplay()
+{
+    uint64_t hash = core.hashDisplay();
+
+    if (hash != lastHash)
+    {
+        log.displayHashes.push_back({frame - 1, hash});
+        lastHash = hash;
+    }
+}
+
+void InputRecorder::finish()
+{
+    if (frame > 0)
+        recordDisplay();
+
+    log.frames = frame;
+}
+
+bool InputRecorder::pollEvents()
+{
+    //Whatever the last frame drew
+    if (frame > 0)
+        recordDisplay();
+
+    if (!source.pollEvents())
+        return false;
+
+    uint16_t current = 0;
+
+    for (unsigned char key = 0; key < 16; key++)
+    {
+        if (source.isKeyDown(key))
+            current |= 1 << key;
+    }
+
+    if (current != keys)
+    {
+        log.keyChanges.push_back({frame, current});
+        keys = current;
+    }
+
+    frame++;
+    keyPressCalls = 0;
+
+    return true;
+}
+
+bool InputRecorder::isKeyDown(unsigned char key)
+{
+    return (keys >> key) & 1;
+}
+
+int InputRecorder::getKeyPress()
+{
+    int key = source.getKeyPress();
+
+    if (key >= 0)
+        log.keyPresses.push_back({frame - 1, keyPressCalls, key});
+
+    keyPressCalls++;
+
+    return key;
+}
+
+InputReplayer::InputReplayer(const Core& core, const InputLog& log, Input* host) : core(core), log(log), host(host)
+{
+    frame = 0;
+    keyPressCalls = 0;
+    keys = 0;
+    expectedHash = core.hashDisplay();
+    nextKeyChange = 0;
+    nextKeyPress = 0;
+    nextDisplayHash = 0;
+    mismatchFrame = -1;
+}
+
+bool InputReplayer::checkDisplay()
+{
+    while (nextDisplayHash < log.displayHashes.size() && log.displayHashes[nextDisplayHash].frame <= frame - 1)
+        expectedHash = log.displayHashes[nextDisplayHash++].hash;
+
+    if (core.hashDisplay() != expectedHash)
+    {
+        mismatchFrame = frame - 1;
+        return false;
+    }
+
+    return true;
+}
+
+bool InputReplayer::checkKeyPresses()
+{
+    //A press the recording used that nothing asked for this time round
+    if (nextKeyPress < log.keyPresses.size() && log.keyPresses[nextKeyPress].frame < frame)
+    {
+        mismatchFrame = log.keyPresses[nextKeyPress].frame;
+        return false;
+    }
+
+    return true;
+}
+
+void InputReplayer::finish()
+{
+    if (frame > 0 && mismatchFrame < 0 && checkDisplay())
+        checkKeyPresses();
+}
+
+bool InputReplayer::pollEvents()
+{
+    if (mismatchFrame >= 0 || (frame > 0 && !checkDisplay()))
+        return false;
+
+    if (!checkKeyPresses())
+        return false;
+
+    if (frame >= log.frames)
+        return false;
+
+    if (host != nullptr && !host->pollEvents())
+        return false;
+
+    while (nextKeyChange < log.keyChanges.size() && log.keyChanges[nextKeyChange].frame <= frame)
+        keys = log.keyChanges[nextKeyChange++].keys;
+
+    frame++;
+    keyPressCalls = 0;
+
+    return true;
+}
+
+bool InputReplayer::isKeyDown(unsigned char key)
+{
+    return (keys >> key) & 1;
+}
+
+int InputReplayer::getKeyPress()
+{
+    uint32_t call = keyPressCalls++;
+
+    if (nextKeyPress < log.keyPresses.size() && log.keyPresses[nextKeyPress].frame == frame - 1 &&
+        log.keyPresses[nextKeyPress].call == call)
+        return log.keyPresses[nextKeyPress++].key;
+
+    return -1;
+}
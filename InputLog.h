@@ -0,0 +1,138 @@
+//
+//  InputLog.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__InputLog__
+#define __Chip8__InputLog__
+
+#include <stdint.h>
+#include <vector>
+
+#include "Core.h"
+#include "Frontend.h"
+
+//Everything a run took from outside the Core - key state per frame, Fx0A key presses, the seed, quirks and rates - plus
+//the display hash whenever it changed, so a replay can tell exactly which frame went differently
+class InputLog
+{
+public:
+    struct KeyChange
+    {
+        uint32_t frame;
+        uint16_t keys;
+    };
+
+    struct KeyPress
+    {
+        uint32_t frame;
+        //Which getKeyPress call in the frame got it, the ones that got nothing aren't logged
+        uint32_t call;
+        int key;
+    };
+
+    struct DisplayHash
+    {
+        //Hash of the display after this frame ran
+        uint32_t frame;
+        uint64_t hash;
+    };
+
+    InputLog ();
+
+    //Seed, rates and the loaded memory of a Core that is about to run
+    void begin (const Core& core);
+    //Seed, quirks and rates back onto a Core, false if it isn't in the same mode with the same memory the log
+    //started with. Set the Core to mode before loading the ROM
+    bool apply (Core& core) const;
+
+    bool save (const char* location) const;
+    bool load (const char* location);
+
+    uint32_t seed;
+    int instructionRate;
+    int timerRate;
+    uint64_t memoryHash;
+    Mode mode;
+    uint8_t quirks;
+    //Frames the recording ran for
+    uint32_t frames;
+
+    //All in frame order, keys only when they changed
+    std::vector<KeyChange> keyChanges;
+    //Only the presses something took
+    std::vector<KeyPress> keyPresses;
+    std::vector<DisplayHash> displayHashes;
+};
+
+//Sits between a Core and the real Input, passing it through and writing the log. Keys are read once a frame
+//and held, so what the Core sees mid-frame is exactly what gets recorded
+class InputRecorder : public Input
+{
+public:
+    InputRecorder (Input& source, const Core& core, InputLog& log);
+
+    //Call after the last frame, records its display
+    void finish ();
+
+    bool pollEvents () override;
+    bool isKeyDown (unsigned char key) override;
+    int getKeyPress () override;
+
+private:
+    void recordDisplay ();
+
+    Input& source;
+    const Core& core;
+    InputLog& log;
+
+    uint32_t frame;
+    uint32_t keyPressCalls;
+    uint16_t keys;
+    uint64_t lastHash;
+};
+
+//Feeds a log back into a Core and checks every frame's display against it. Stops the Core (pollEvents
+//returns false) at the end of the log or on the first frame that doesn't match
+class InputReplayer : public Input
+{
+public:
+    //host, if there is one, is still polled every frame so a window can be closed mid replay
+    InputReplayer (const Core& core, const InputLog& log, Input* host = nullptr);
+
+    //Call after the Core stops, checks the last frame
+    void finish ();
+
+    //Frame whose display didn't match, -1 if they all did so far
+    long getMismatchFrame () const { return mismatchFrame; }
+    bool isComplete () const { return frame >= log.frames && mismatchFrame < 0; }
+    uint32_t getFrame () const { return frame; }
+
+    bool pollEvents () override;
+    bool isKeyDown (unsigned char key) override;
+    int getKeyPress () override;
+
+private:
+    //Compares the display after frame - 1 with the log
+    bool checkDisplay ();
+    //Every press logged before frame has been taken
+    bool checkKeyPresses ();
+
+    const Core& core;
+    const InputLog& log;
+    Input* host;
+
+    uint32_t frame;
+    uint32_t keyPressCalls;
+    uint16_t keys;
+    uint64_t expectedHash;
+    size_t nextKeyChange;
+    size_t nextKeyPress;
+    size_t nextDisplayHash;
+    long mismatchFrame;
+};
+
+#endif /* defined(__Chip8__InputLog__) */
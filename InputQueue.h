@@ -0,0 +1,78 @@
+//
+//  InputQueue.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__InputQueue__
+#define __Chip8__InputQueue__
+
+#include <stdint.h>
+#include <atomic>
+
+enum InputEventType
+{
+    INPUT_KEY_DOWN,
+    INPUT_KEY_UP,
+    INPUT_REWIND_DOWN,
+    INPUT_REWIND_UP
+};
+
+struct InputEvent
+{
+    uint8_t type;
+    //Chip8 key, for the key events
+    uint8_t key;
+};
+
+//Key events from the window thread to the emulation thread, in order. Single producer and single consumer like
+//SampleRing, so no locks, and small enough to just be an array
+class InputQueue
+{
+public:
+    static const uint32_t capacity = 256;
+
+    InputQueue ()
+    {
+        head = 0;
+        tail = 0;
+    }
+
+    //Window thread, false when it's full - the emulation thread has fallen behind or stopped taking them
+    bool push (InputEvent event)
+    {
+        uint32_t write = head.load(std::memory_order_relaxed);
+
+        if (write - tail.load(std::memory_order_acquire) == capacity)
+            return false;
+
+        events[write % capacity] = event;
+        head.store(write + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    //Emulation thread, false when there's nothing waiting
+    bool pop (InputEvent& event)
+    {
+        uint32_t read = tail.load(std::memory_order_relaxed);
+
+        if (read == head.load(std::memory_order_acquire))
+            return false;
+
+        event = events[read % capacity];
+        tail.store(read + 1, std::memory_order_release);
+
+        return true;
+    }
+
+private:
+    InputEvent events [capacity];
+
+    alignas(64) std::atomic<uint32_t> head;
+    alignas(64) std::atomic<uint32_t> tail;
+};
+
+#endif /* defined(__Chip8__InputQueue__) */
@@ -0,0 +1,927 @@
+//
+//  Lockstep.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include <algorithm>
+
+#include "Lockstep.h"
+#include "Hash.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+//Lanes per vector of bytes, stride is always a multiple of this
+static const int laneBlock = 32;
+
+//The byte helpers work on whole vectors of lanes with a mask of 0xFF (take part) or 0x00 (leave alone).
+//Every one has an AVX2 version where that's compiled in, an SSE2 one for any other x86-64 build and a plain
+//loop version for everything else
+
+#if !defined(__AVX2__) && defined(__SSE2__)
+//mask ? value : old, SSE2 has no blendv but the masks are always whole bytes of 0xFF or 0x00
+static inline __m128i blend (__m128i old, __m128i value, __m128i mask)
+{
+    return _mm_or_si128(_mm_and_si128(mask, value), _mm_andnot_si128(mask, old));
+}
+
+//8 bytes of 0xFF / 0x00 mask widened to 8 words of 0xFFFF / 0x0000
+static inline __m128i widenMask (const uint8_t* mask)
+{
+    __m128i m = _mm_loadl_epi64((const __m128i*) mask);
+    return _mm_unpacklo_epi8(m, m);
+}
+#endif
+
+//dst = mask ? value : dst
+static void selectSet (uint8_t* dst, uint8_t value, const uint8_t* mask, int count)
+{
+#ifdef __AVX2__
+    __m256i values = _mm256_set1_epi8((char) value);
+
+    for (int i = 0; i < count; i += 32)
+    {
+        __m256i m = _mm256_loadu_si256((const __m256i*) &mask[i]);
+        __m256i d = _mm256_loadu_si256((const __m256i*) &dst[i]);
+        _mm256_storeu_si256((__m256i*) &dst[i], _mm256_blendv_epi8(d, values, m));
+    }
+#elif defined(__SSE2__)
+    __m128i values = _mm_set1_epi8((char) value);
+
+    for (int i = 0; i < count; i += 16)
+    {
+        __m128i m = _mm_loadu_si128((const __m128i*) &mask[i]);
+        __m128i d = _mm_loadu_si128((const __m128i*) &dst[i]);
+        _mm_storeu_si128((__m128i*) &dst[i], blend(d, values, m));
+    }
+#else
+    for (int i = 0; i < count; i++)
+        dst[i] = (value & mask[i]) | (dst[i] & ~mask[i]);
+#endif
+}
+
+//dst += mask ? value : 0
+static void selectAdd (uint8_t* dst, uint8_t value, const uint8_t* mask, int count)
+{
+#ifdef __AVX2__
+    __m256i values = _mm256_set1_epi8((char) value);
+
+    for (int i = 0; i < count; i += 32)
+    {
+        __m256i m = _mm256_loadu_si256((const __m256i*) &mask[i]);
+        __m256i d = _mm256_loadu_si256((const __m256i*) &dst[i]);
+        _mm256_storeu_si256((__m256i*) &dst[i], _mm256_add_epi8(d, _mm256_and_si256(values, m)));
+    }
+#elif defined(__SSE2__)
+    __m128i values = _mm_set1_epi8((char) value);
+
+    for (int i = 0; i < count; i += 16)
+    {
+        __m128i m = _mm_loadu_si128((const __m128i*) &mask[i]);
+        __m128i d = _mm_loadu_si128((const __m128i*) &dst[i]);
+        _mm_storeu_si128((__m128i*) &dst[i], _mm_add_epi8(d, _mm_and_si128(values, m)));
+    }
+#else
+    for (int i = 0; i < count; i++)
+        dst[i] += value & mask[i];
+#endif
+}
+
+//8XY0 - 8XY3, dst = mask ? dst op src : dst
+static void selectLogic (uint8_t* dst, const uint8_t* src, const uint8_t* mask, int count, Op op)
+{
+#ifdef __AVX2__
+    for (int i = 0; i < count; i += 32)
+    {
+        __m256i m = _mm256_loadu_si256((const __m256i*) &mask[i]);
+        __m256i d = _mm256_loadu_si256((const __m256i*) &dst[i]);
+        __m256i s = _mm256_loadu_si256((const __m256i*) &src[i]);
+        __m256i r;
+
+        switch (op)
+        {
+            case OP_OR: r = _mm256_or_si256(d, s); break;
+            case OP_AND: r = _mm256_and_si256(d, s); break;
+            case OP_XOR: r = _mm256_xor_si256(d, s); break;
+            default: r = s; break;
+        }
+
+        _mm256_storeu_si256((__m256i*) &dst[i], _mm256_blendv_epi8(d, r, m));
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < count; i += 16)
+    {
+        __m128i m = _mm_loadu_si128((const __m128i*) &mask[i]);
+        __m128i d = _mm_loadu_si128((const __m128i*) &dst[i]);
+        __m128i s = _mm_loadu_si128((const __m128i*) &src[i]);
+        __m128i r;
+
+        switch (op)
+        {
+            case OP_OR: r = _mm_or_si128(d, s); break;
+            case OP_AND: r = _mm_and_si128(d, s); break;
+            case OP_XOR: r = _mm_xor_si128(d, s); break;
+            default: r = s; break;
+        }
+
+        _mm_storeu_si128((__m128i*) &dst[i], blend(d, r, m));
+    }
+#else
+    for (int i = 0; i < count; i++)
+    {
+        uint8_t r;
+
+        switch (op)
+        {
+            case OP_OR: r = dst[i] | src[i]; break;
+            case OP_AND: r = dst[i] & src[i]; break;
+            case OP_XOR: r = dst[i] ^ src[i]; break;
+            default: r = src[i]; break;
+        }
+
+        dst[i] = (r & mask[i]) | (dst[i] & ~mask[i]);
+    }
+#endif
+}
+
+//out = mask & ((a == b) != notEqual), b is either another register row or a repeated byte
+static void compare (uint8_t* out, const uint8_t* a, const uint8_t* b, uint8_t value, bool notEqual, const uint8_t* mask, int count)
+{
+#ifdef __AVX2__
+    __m256i values = _mm256_set1_epi8((char) value);
+    __m256i invert = notEqual ? _mm256_set1_epi8((char) 0xFF) : _mm256_setzero_si256();
+
+    for (int i = 0; i < count; i += 32)
+    {
+        __m256i m = _mm256_loadu_si256((const __m256i*) &mask[i]);
+        __m256i left = _mm256_loadu_si256((const __m256i*) &a[i]);
+        __m256i right = b != nullptr ? _mm256_loadu_si256((const __m256i*) &b[i]) : values;
+        __m256i equal = _mm256_xor_si256(_mm256_cmpeq_epi8(left, right), invert);
+        _mm256_storeu_si256((__m256i*) &out[i], _mm256_and_si256(equal, m));
+    }
+#elif defined(__SSE2__)
+    __m128i values = _mm_set1_epi8((char) value);
+    __m128i invert = notEqual ? _mm_set1_epi8((char) 0xFF) : _mm_setzero_si128();
+
+    for (int i = 0; i < count; i += 16)
+    {
+        __m128i m = _mm_loadu_si128((const __m128i*) &mask[i]);
+        __m128i left = _mm_loadu_si128((const __m128i*) &a[i]);
+        __m128i right = b != nullptr ? _mm_loadu_si128((const __m128i*) &b[i]) : values;
+        __m128i equal = _mm_xor_si128(_mm_cmpeq_epi8(left, right), invert);
+        _mm_storeu_si128((__m128i*) &out[i], _mm_and_si128(equal, m));
+    }
+#else
+    for (int i = 0; i < count; i++)
+    {
+        bool equal = a[i] == (b != nullptr ? b[i] : value);
+        out[i] = (equal != notEqual) ? mask[i] : 0;
+    }
+#endif
+}
+
+//Saturating decrement of a timer row
+static void tick (uint8_t* timer, const uint8_t* mask, int count)
+{
+#ifdef __AVX2__
+    __m256i one = _mm256_set1_epi8(1);
+
+    for (int i = 0; i < count; i += 32)
+    {
+        __m256i m = _mm256_loadu_si256((const __m256i*) &mask[i]);
+        __m256i t = _mm256_loadu_si256((const __m256i*) &timer[i]);
+        _mm256_storeu_si256((__m256i*) &timer[i], _mm256_subs_epu8(t, _mm256_and_si256(one, m)));
+    }
+#elif defined(__SSE2__)
+    __m128i one = _mm_set1_epi8(1);
+
+    for (int i = 0; i < count; i += 16)
+    {
+        __m128i m = _mm_loadu_si128((const __m128i*) &mask[i]);
+        __m128i t = _mm_loadu_si128((const __m128i*) &timer[i]);
+        _mm_storeu_si128((__m128i*) &timer[i], _mm_subs_epu8(t, _mm_and_si128(one, m)));
+    }
+#else
+    for (int i = 0; i < count; i++)
+    {
+        if (mask[i] && timer[i] > 0)
+            timer[i]--;
+    }
+#endif
+}
+
+//xorshift32 step for every lane in the mask, same as Core::random
+static void advanceRandom (uint32_t* state, const uint8_t* mask, int count)
+{
+#ifdef __AVX2__
+    for (int i = 0; i < count; i += 8)
+    {
+        __m256i m = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*) &mask[i]));
+        __m256i x = _mm256_loadu_si256((const __m256i*) &state[i]);
+        __m256i r = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+        r = _mm256_xor_si256(r, _mm256_srli_epi32(r, 17));
+        r = _mm256_xor_si256(r, _mm256_slli_epi32(r, 5));
+        _mm256_storeu_si256((__m256i*) &state[i], _mm256_blendv_epi8(x, r, m));
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < count; i += 4)
+    {
+        //Four bytes of mask to doublewords, still all ones or all zeros
+        int bytes;
+        memcpy(&bytes, &mask[i], sizeof(bytes));
+        __m128i m = _mm_cvtsi32_si128(bytes);
+        m = _mm_unpacklo_epi8(m, m);
+        m = _mm_unpacklo_epi16(m, m);
+        __m128i x = _mm_loadu_si128((const __m128i*) &state[i]);
+        __m128i r = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        r = _mm_xor_si128(r, _mm_srli_epi32(r, 17));
+        r = _mm_xor_si128(r, _mm_slli_epi32(r, 5));
+        _mm_storeu_si128((__m128i*) &state[i], blend(x, r, m));
+    }
+#else
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t x = state[i];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state[i] = mask[i] ? x : state[i];
+    }
+#endif
+}
+
+//Lowest pc of any lane in pending (0xFFFF lanes)
+static uint16_t lowestPending (const uint16_t* pc, const uint16_t* pending, int count)
+{
+#ifdef __AVX2__
+    __m256i lowest = _mm256_set1_epi16((short) 0xFFFF);
+
+    for (int i = 0; i < count; i += 16)
+    {
+        __m256i p = _mm256_loadu_si256((const __m256i*) &pc[i]);
+        __m256i m = _mm256_loadu_si256((const __m256i*) &pending[i]);
+        //Lanes outside the mask become 0xFFFF so they never win
+        lowest = _mm256_min_epu16(lowest, _mm256_or_si256(p, _mm256_xor_si256(m, _mm256_set1_epi16((short) 0xFFFF))));
+    }
+
+    __m128i half = _mm_min_epu16(_mm256_castsi256_si128(lowest), _mm256_extracti128_si256(lowest, 1));
+    return (uint16_t) _mm_cvtsi128_si32(_mm_minpos_epu16(half));
+#elif defined(__SSE2__)
+    //SSE2 only has a signed 16 bit min, flipping the top bit puts unsigned values in the same order
+    __m128i bias = _mm_set1_epi16((short) 0x8000);
+    __m128i ones = _mm_set1_epi16((short) 0xFFFF);
+    __m128i lowest = _mm_set1_epi16(0x7FFF);
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i*) &pc[i]);
+        __m128i m = _mm_loadu_si128((const __m128i*) &pending[i]);
+        lowest = _mm_min_epi16(lowest, _mm_xor_si128(_mm_or_si128(p, _mm_xor_si128(m, ones)), bias));
+    }
+
+    lowest = _mm_min_epi16(lowest, _mm_srli_si128(lowest, 8));
+    lowest = _mm_min_epi16(lowest, _mm_srli_si128(lowest, 4));
+    lowest = _mm_min_epi16(lowest, _mm_srli_si128(lowest, 2));
+    return (uint16_t) (_mm_cvtsi128_si32(lowest) ^ 0x8000);
+#else
+    uint16_t lowest = 0xFFFF;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (pending[i] && pc[i] < lowest)
+            lowest = pc[i];
+    }
+
+    return lowest;
+#endif
+}
+
+//group = pending & (pc == address), returns how many lanes are in it
+static int buildGroup (uint8_t* group, const uint16_t* pc, uint16_t address, const uint16_t* pending, int count)
+{
+    int size = 0;
+
+#ifdef __AVX2__
+    __m256i addresses = _mm256_set1_epi16((short) address);
+
+    for (int i = 0; i < count; i += 32)
+    {
+        __m256i low = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*) &pc[i]), addresses);
+        __m256i high = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*) &pc[i + 16]), addresses);
+        low = _mm256_and_si256(low, _mm256_loadu_si256((const __m256i*) &pending[i]));
+        high = _mm256_and_si256(high, _mm256_loadu_si256((const __m256i*) &pending[i + 16]));
+        //packs works within 128 bit halves, put the quarters back in lane order
+        __m256i same = _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0xD8);
+        _mm256_storeu_si256((__m256i*) &group[i], same);
+        size += __builtin_popcount((unsigned int) _mm256_movemask_epi8(same));
+    }
+#elif defined(__SSE2__)
+    __m128i addresses = _mm_set1_epi16((short) address);
+
+    for (int i = 0; i < count; i += 16)
+    {
+        __m128i low = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*) &pc[i]), addresses);
+        __m128i high = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*) &pc[i + 8]), addresses);
+        low = _mm_and_si128(low, _mm_loadu_si128((const __m128i*) &pending[i]));
+        high = _mm_and_si128(high, _mm_loadu_si128((const __m128i*) &pending[i + 8]));
+        __m128i same = _mm_packs_epi16(low, high);
+        _mm_storeu_si128((__m128i*) &group[i], same);
+        size += __builtin_popcount((unsigned int) _mm_movemask_epi8(same));
+    }
+#else
+    for (int i = 0; i < count; i++)
+    {
+        group[i] = (pc[i] == address && pending[i]) ? 0xFF : 0;
+        size += group[i] & 1;
+    }
+#endif
+
+    return size;
+}
+
+//Every lane in the group has used one more instruction of its budget, the ones out of budget stop pending
+static void retire (uint16_t* remaining, uint16_t* pending, const uint8_t* group, int count)
+{
+#ifdef __AVX2__
+    __m256i zero = _mm256_setzero_si256();
+    __m256i ones = _mm256_set1_epi16((short) 0xFFFF);
+
+    for (int i = 0; i < count; i += 16)
+    {
+        //0xFF widens to 0xFFFF, adding it is taking one off
+        __m256i g = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*) &group[i]));
+        __m256i r = _mm256_add_epi16(_mm256_loadu_si256((const __m256i*) &remaining[i]), g);
+        _mm256_storeu_si256((__m256i*) &remaining[i], r);
+        _mm256_storeu_si256((__m256i*) &pending[i], _mm256_xor_si256(_mm256_cmpeq_epi16(r, zero), ones));
+    }
+#elif defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i ones = _mm_set1_epi16((short) 0xFFFF);
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m128i r = _mm_add_epi16(_mm_loadu_si128((const __m128i*) &remaining[i]), widenMask(&group[i]));
+        _mm_storeu_si128((__m128i*) &remaining[i], r);
+        _mm_storeu_si128((__m128i*) &pending[i], _mm_xor_si128(_mm_cmpeq_epi16(r, zero), ones));
+    }
+#else
+    for (int i = 0; i < count; i++)
+    {
+        remaining[i] -= group[i] & 1;
+        pending[i] = remaining[i] != 0 ? 0xFFFF : 0;
+    }
+#endif
+}
+
+//dst = mask ? value : dst, for the 16 bit rows
+static void selectSetWord (uint16_t* dst, uint16_t value, const uint8_t* mask, int count)
+{
+#ifdef __AVX2__
+    __m256i values = _mm256_set1_epi16((short) value);
+
+    for (int i = 0; i < count; i += 16)
+    {
+        __m256i m = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*) &mask[i]));
+        __m256i d = _mm256_loadu_si256((const __m256i*) &dst[i]);
+        _mm256_storeu_si256((__m256i*) &dst[i], _mm256_blendv_epi8(d, values, m));
+    }
+#elif defined(__SSE2__)
+    __m128i values = _mm_set1_epi16((short) value);
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m128i d = _mm_loadu_si128((const __m128i*) &dst[i]);
+        _mm_storeu_si128((__m128i*) &dst[i], blend(d, values, widenMask(&mask[i])));
+    }
+#else
+    for (int i = 0; i < count; i++)
+        dst[i] = mask[i] ? value : dst[i];
+#endif
+}
+
+//pc = mask ? address + 2 (+ 2 more where skip is set) : pc
+static void advance (uint16_t* pc, uint16_t address, const uint8_t* mask, const uint8_t* skip, int count)
+{
+    uint16_t next = address + 2;
+
+    if (skip == nullptr)
+    {
+        selectSetWord(pc, next, mask, count);
+        return;
+    }
+
+#ifdef __AVX2__
+    __m256i nexts = _mm256_set1_epi16((short) next);
+    __m256i two = _mm256_set1_epi16(2);
+
+    for (int i = 0; i < count; i += 16)
+    {
+        __m256i m = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*) &mask[i]));
+        __m256i s = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*) &skip[i]));
+        __m256i target = _mm256_add_epi16(nexts, _mm256_and_si256(s, two));
+        __m256i p = _mm256_loadu_si256((const __m256i*) &pc[i]);
+        _mm256_storeu_si256((__m256i*) &pc[i], _mm256_blendv_epi8(p, target, m));
+    }
+#elif defined(__SSE2__)
+    __m128i nexts = _mm_set1_epi16((short) next);
+    __m128i two = _mm_set1_epi16(2);
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m128i target = _mm_add_epi16(nexts, _mm_and_si128(widenMask(&skip[i]), two));
+        __m128i p = _mm_loadu_si128((const __m128i*) &pc[i]);
+        _mm_storeu_si128((__m128i*) &pc[i], blend(p, target, widenMask(&mask[i])));
+    }
+#else
+    for (int i = 0; i < count; i++)
+    {
+        uint16_t target = next + (skip[i] & 2);
+        pc[i] = mask[i] ? target : pc[i];
+    }
+#endif
+}
+
+Lockstep::Lockstep (int count)
+{
+    instances = count > 0 ? count : 1;
+    stride = (instances + laneBlock - 1) / laneBlock * laneBlock;
+
+    V.resize(16 * stride);
+    I.resize(stride);
+    pc.resize(stride);
+    sp.resize(stride);
+    stack.resize(16 * stride);
+    dt.resize(stride);
+    st.resize(stride);
+    display.resize(32 * stride);
+    randomState.resize(stride);
+    memory.resize((size_t) stride * 0x1000);
+
+    live.resize(stride);
+    waiting.resize(stride);
+    status.resize(stride);
+    unhandledOpcode.resize(stride);
+    cycles.resize(stride);
+
+    remaining.resize(stride);
+    pending.resize(stride);
+    group.resize(stride);
+    condition.resize(stride);
+
+    decodeTable = getDecodeTable();
+    loaded = false;
+
+    instructionRate = 540;
+    timerRate = 60;
+    instructionCredit = 0;
+
+    memset(image, 0, sizeof(image));
+    writtenPages = 0;
+
+    //Lane n starts where a Core seeded with n would
+    for (int lane = 0; lane < stride; lane++)
+        seed(lane, lane);
+
+    reset();
+}
+
+void Lockstep::seed (int lane, uint32_t value)
+{
+    randomState[lane] = value != 0 ? value : 0x9E3779B9;
+}
+
+bool Lockstep::loadROM (const unsigned char* data, size_t size)
+{
+    //Let a Core do the loading so the interpreter area and size checks are exactly the same
+    Core core;
+
+    if (!core.loadROM(data, size))
+        return false;
+
+    memcpy(image, core.getMemory(), sizeof(image));
+    loaded = true;
+    reset();
+
+    return true;
+}
+
+bool Lockstep::loadFile (const char* location)
+{
+    Core core;
+
+    if (!core.loadFile(location))
+        return false;
+
+    memcpy(image, core.getMemory(), sizeof(image));
+    loaded = true;
+    reset();
+
+    return true;
+}
+
+bool Lockstep::loadState (const Snapshot& snapshot)
+{
+    //The lanes are plain CHIP-8 only, with its usual quirks
+    if (!snapshot.isValid() || snapshot.mode != MODE_CHIP8 || snapshot.quirks != getDefaultQuirks(MODE_CHIP8))
+        return false;
+
+    //Whatever the snapshot has in memory counts as the loaded image, nothing has diverged from it yet
+    memcpy(image, snapshot.memory, sizeof(image));
+    loaded = true;
+    reset();
+
+    instructionCredit = snapshot.instructionCredit;
+
+    for (int lane = 0; lane < stride; lane++)
+    {
+        for (int index = 0; index < 16; index++)
+        {
+            V[index * stride + lane] = snapshot.registers[index];
+            stack[index * stride + lane] = snapshot.stack[index];
+        }
+
+        for (int row = 0; row < 32; row++)
+            display[row * stride + lane] = snapshot.display[row];
+
+        I[lane] = snapshot.I;
+        pc[lane] = snapshot.pc;
+        sp[lane] = snapshot.sp;
+        dt[lane] = snapshot.dt;
+        st[lane] = snapshot.st;
+        status[lane] = snapshot.status;
+        waiting[lane] = snapshot.waitingForKey ? 0xFF : 0;
+        unhandledOpcode[lane] = snapshot.unhandledOpcode;
+        cycles[lane] = snapshot.cycles;
+    }
+
+    return true;
+}
+
+void Lockstep::reset ()
+{
+    fill(V.begin(), V.end(), 0);
+    fill(I.begin(), I.end(), 0);
+    fill(pc.begin(), pc.end(), 0x200);
+    fill(sp.begin(), sp.end(), 0);
+    fill(stack.begin(), stack.end(), 0);
+    fill(dt.begin(), dt.end(), 0);
+    fill(st.begin(), st.end(), 0);
+    fill(display.begin(), display.end(), 0);
+    fill(waiting.begin(), waiting.end(), 0);
+    fill(status.begin(), status.end(), STATUS_RUNNING);
+    fill(unhandledOpcode.begin(), unhandledOpcode.end(), 0);
+    fill(cycles.begin(), cycles.end(), 0);
+
+    for (int lane = 0; lane < stride; lane++)
+    {
+        memcpy(&memory[(size_t) lane * 0x1000], image, sizeof(image));
+        live[lane] = lane < instances ? 0xFF : 0;
+    }
+
+    writtenPages = 0;
+    instructionCredit = 0;
+}
+
+long Lockstep::run (long frames)
+{
+    if (!loaded)
+    {
+        cerr << "A game file must be loaded before emulation" << endl;
+        exit(1);
+    }
+
+    long frame;
+
+    for (frame = 0; frames < 0 || frame < frames; frame++)
+    {
+        bool anyLive = false;
+
+        //Same as Core::run - a lane that stopped during the last frame is done from here on
+        for (int lane = 0; lane < instances; lane++)
+        {
+            if (status[lane] != STATUS_RUNNING)
+                live[lane] = 0;
+
+            anyLive |= live[lane] != 0;
+        }
+
+        if (!anyLive)
+            break;
+
+        emulateFrame();
+    }
+
+    return frame;
+}
+
+void Lockstep::emulateFrame ()
+{
+    instructionCredit += instructionRate;
+    int count = (int) (instructionCredit / timerRate);
+    instructionCredit -= (long) count * timerRate;
+
+    //Budgets are 16 bit, nothing between timer ticks depends on where the frame is cut
+    while (count > 0)
+    {
+        int budget = min(count, 0x7FFF);
+        runBudget(budget);
+        count -= budget;
+    }
+
+    tick(dt.data(), live.data(), stride);
+    tick(st.data(), live.data(), stride);
+}
+
+bool Lockstep::isCodeShared (unsigned short address) const
+{
+    int page = (address & 0xFFF) >> 6;
+    int next = ((address + 1) & 0xFFF) >> 6;
+
+    return ((writtenPages >> page) & 1) == 0 && ((writtenPages >> next) & 1) == 0;
+}
+
+unsigned short Lockstep::fetch (int lane, unsigned short address) const
+{
+    const uint8_t* laneMemory = &memory[(size_t) lane * 0x1000];
+    return (laneMemory[address & 0xFFF] << 8) | laneMemory[(address + 1) & 0xFFF];
+}
+
+void Lockstep::runBudget (int budget)
+{
+    long outstanding = 0;
+
+    for (int lane = 0; lane < stride; lane++)
+    {
+        //Same as Core::startFrame, a lane waiting on Fx0A runs nothing
+        bool running = live[lane] && !waiting[lane];
+        remaining[lane] = running ? budget : 0;
+        pending[lane] = running ? 0xFFFF : 0;
+        outstanding += remaining[lane];
+        cycles[lane] += remaining[lane];
+    }
+
+    //Lanes don't depend on each other inside a frame, so the order they run in is free as long as each one gets
+    //exactly its budget. Always running the lowest pc lets lanes that fell behind (one took a skip, the other
+    //didn't) catch up to the rest and join them again instead of staying a step out of phase forever
+    while (outstanding > 0)
+    {
+        unsigned short address = lowestPending(pc.data(), pending.data(), stride);
+        int size = buildGroup(group.data(), pc.data(), address, pending.data(), stride);
+        unsigned short opcode;
+
+        if (isCodeShared(address))
+            opcode = (image[address & 0xFFF] << 8) | image[(address + 1) & 0xFFF];
+        else
+        {
+            //Someone has written over code here, only lanes that still have the same opcode as the first go together
+            int leader = 0;
+
+            while (!group[leader])
+                leader++;
+
+            opcode = fetch(leader, address);
+
+            for (int lane = leader + 1; lane < instances; lane++)
+            {
+                if (group[lane] && fetch(lane, address) != opcode)
+                {
+                    group[lane] = 0;
+                    size--;
+                }
+            }
+        }
+
+        execute(address, decodeTable[opcode], group.data());
+        retire(remaining.data(), pending.data(), group.data(), stride);
+        outstanding -= size;
+
+        //Fx0A stops the frame where it is, like the Core's dispatch loops. What's left of the budget never runs
+        if (decodeTable[opcode].op == OP_LD_VX_K)
+        {
+            for (int lane = 0; lane < instances; lane++)
+            {
+                if (!group[lane])
+                    continue;
+
+                waiting[lane] = 0xFF;
+                outstanding -= remaining[lane];
+                cycles[lane] -= remaining[lane];
+                remaining[lane] = 0;
+                pending[lane] = 0;
+            }
+        }
+    }
+}
+
+void Lockstep::execute (unsigned short address, const Instruction& instruction, uint8_t* mask)
+{
+    uint8_t* vx = &V[instruction.x * stride];
+    uint8_t* vy = &V[instruction.y * stride];
+
+    switch (instruction.op)
+    {
+        case OP_LD_BYTE:
+            selectSet(vx, instruction.nn, mask, stride);
+            advance(pc.data(), address, mask, nullptr, stride);
+            return;
+        case OP_ADD_BYTE:
+            selectAdd(vx, instruction.nn, mask, stride);
+            advance(pc.data(), address, mask, nullptr, stride);
+            return;
+        case OP_LD_REG:
+        case OP_OR:
+        case OP_AND:
+        case OP_XOR:
+            selectLogic(vx, vy, mask, stride, instruction.op);
+            advance(pc.data(), address, mask, nullptr, stride);
+            return;
+        case OP_SE_BYTE:
+        case OP_SNE_BYTE:
+            compare(condition.data(), vx, nullptr, instruction.nn, instruction.op == OP_SNE_BYTE, mask, stride);
+            advance(pc.data(), address, mask, condition.data(), stride);
+            return;
+        case OP_SE_REG:
+        case OP_SNE_REG:
+            compare(condition.data(), vx, vy, 0, instruction.op == OP_SNE_REG, mask, stride);
+            advance(pc.data(), address, mask, condition.data(), stride);
+            return;
+        case OP_SKP:
+            //No keyboard - never pressed
+            advance(pc.data(), address, mask, nullptr, stride);
+            return;
+        case OP_SKNP:
+            advance(pc.data(), address, mask, mask, stride);
+            return;
+        case OP_LD_I:
+            selectSetWord(I.data(), instruction.nnn, mask, stride);
+            advance(pc.data(), address, mask, nullptr, stride);
+            return;
+        case OP_RND:
+            advanceRandom(randomState.data(), mask, stride);
+
+            for (int lane = 0; lane < stride; lane++)
+                vx[lane] = mask[lane] ? ((randomState[lane] >> 24) & instruction.nn) : vx[lane];
+
+            advance(pc.data(), address, mask, nullptr, stride);
+            return;
+        case OP_JP:
+            //A jump to itself doesn't halt, that's the Core's idle skipping
+            selectSetWord(pc.data(), instruction.nnn, mask, stride);
+            return;
+        default:
+            break;
+    }
+
+    for (int lane = 0; lane < instances; lane++)
+    {
+        if (mask[lane])
+            executeLane(lane, address, instruction);
+    }
+}
+
+void Lockstep::executeLane (int lane, unsigned short address, const Instruction& instruction)
+{
+    //Same as the Core handlers, with everything indexed by lane
+    uint8_t* laneMemory = &memory[(size_t) lane * 0x1000];
+    uint8_t& vx = V[instruction.x * stride + lane];
+    uint8_t& vy = V[instruction.y * stride + lane];
+    uint8_t& vf = V[0xF * stride + lane];
+    uint16_t& laneI = I[lane];
+    uint16_t& lanePC = pc[lane];
+
+    lanePC = address + 2;
+
+    switch (instruction.op)
+    {
+        case OP_SYS:
+            break;
+        case OP_CLS:
+            for (int row = 0; row < 32; row++)
+                display[row * stride + lane] = 0;
+            break;
+        case OP_RET:
+            lanePC = stack[((--sp[lane]) & 0xF) * stride + lane];
+            break;
+        case OP_CALL:
+            stack[((sp[lane]++) & 0xF) * stride + lane] = lanePC;
+            //fall through - the rest is a jump
+        case OP_JP:
+            lanePC = instruction.nnn;
+            break;
+        case OP_JP_V0:
+            lanePC = instruction.nnn + V[lane];
+            break;
+        case OP_ADD_REG:
+        {
+            unsigned short result = vx + vy;
+            vf = result > 255;
+            vx = result;
+            break;
+        }
+        case OP_SUB:
+            vf = vx > vy;
+            vx -= vy;
+            break;
+        case OP_SHR:
+            vf = vx & 0x1;
+            vx >>= 1;
+            break;
+        case OP_SUBN:
+            vf = vy > vx;
+            vx = vy - vx;
+            break;
+        case OP_SHL:
+            vf = (vx & 0x80) > 0;
+            vx <<= 1;
+            break;
+        case OP_DRW:
+        {
+            unsigned int x = vx & 63;
+            unsigned int y = vy & 31;
+            uint64_t collision = 0;
+
+            for (int yline = 0; yline < instruction.n; yline++)
+            {
+                uint64_t sprite = (uint64_t) laneMemory[(laneI + yline) & 0xFFF] << 56;
+                sprite = (sprite >> x) | (sprite << ((64 - x) & 63));
+
+                uint64_t& row = display[((y + yline) & 31) * stride + lane];
+                collision |= row & sprite;
+                row ^= sprite;
+            }
+
+            vf = collision != 0;
+            break;
+        }
+        case OP_LD_VX_DT:
+            vx = dt[lane];
+            break;
+        case OP_LD_VX_K:
+            //Nothing will ever be pressed, sit here. runBudget stops the lane
+            lanePC = address;
+            break;
+        case OP_LD_DT:
+            dt[lane] = vx;
+            break;
+        case OP_LD_ST:
+            st[lane] = vx;
+            break;
+        case OP_ADD_I:
+            vf = (laneI + vx) > 0xFFF;
+            laneI += vx;
+            break;
+        case OP_LD_F:
+            laneI = vx * 5;
+            break;
+        case OP_LD_B:
+        {
+            int v = vx;
+
+            for (int i = 2; i >= 0; i--)
+            {
+                laneMemory[(laneI + i) & 0xFFF] = v % 10;
+                writtenPages |= 1ull << (((laneI + i) & 0xFFF) >> 6);
+                v /= 10;
+            }
+            break;
+        }
+        case OP_LD_MEM:
+            for (int i = 0; i <= instruction.x; i++)
+            {
+                laneMemory[(laneI + i) & 0xFFF] = V[i * stride + lane];
+                writtenPages |= 1ull << (((laneI + i) & 0xFFF) >> 6);
+            }
+            break;
+        case OP_LD_REGS:
+            for (int i = 0; i <= instruction.x; i++)
+                V[i * stride + lane] = laneMemory[(laneI + i) & 0xFFF];
+            break;
+        case OP_UNHANDLED:
+            lanePC = address;
+            unhandledOpcode[lane] = fetch(lane, address);
+            status[lane] = STATUS_UNHANDLED_OPCODE;
+            break;
+        default:
+            //Everything else is handled for the whole group in execute
+            break;
+    }
+}
+
+uint64_t Lockstep::hashDisplay (int lane) const
+{
+    uint64_t hash = fnv1aBasis;
+
+    //A row at a time, they're a stride apart
+    for (int row = 0; row < 32; row++)
+        hash = fnv1a(&display[row * stride + lane], sizeof(uint64_t), hash);
+
+    return hash;
+}
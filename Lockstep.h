@@ -0,0 +1,122 @@
+//
+//  Lockstep.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Lockstep__
+#define __Chip8__Lockstep__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "Core.h"
+#include "Decode.h"
+#include "Snapshot.h"
+
+//Many copies of the same ROM run side by side with the state laid out structure-of-arrays, V3 of every lane
+//next to each other and so on. Every lane sitting on the same instruction executes it together, the common
+//ALU ops with AVX2 where it's compiled in and SSE2 on any other x86-64, so a seed sweep of CXNN costs a
+//fraction of running that many Cores. Lanes that split up (a skip going different ways) run as separate groups
+//until they meet again. There's no input, so each lane behaves exactly like a headless Core with the same seed
+//and idle skipping off
+class Lockstep
+{
+public:
+    Lockstep (int instances);
+
+    //Same ROM in every lane, resets them all
+    bool loadROM (const unsigned char* data, size_t size);
+    bool loadFile (const char* location);
+
+    //Every lane carries on from the snapshot, apart from the random numbers - each keeps its own seed so
+    //a sweep can fork one warmed up machine
+    bool loadState (const Snapshot& snapshot);
+
+    void seed (int lane, uint32_t value);
+
+    void setInstructionRate (int rate) { instructionRate = rate; }
+    void setTimerRate (int rate) { timerRate = rate; }
+    void setCyclesPerFrame (int count) { instructionRate = count * timerRate; }
+
+    //Same as Core::run for every lane at once, stops early once every lane has stopped. Returns frames run
+    long run (long frames);
+    void emulateFrame ();
+
+    int getInstances () const { return instances; }
+
+    Status getStatus (int lane) const { return (Status) status[lane]; }
+    unsigned short getUnhandledOpcode (int lane) const { return unhandledOpcode[lane]; }
+    uint64_t getCycles (int lane) const { return cycles[lane]; }
+    unsigned char getRegister (int lane, int index) const { return V[index * stride + lane]; }
+    unsigned short getI (int lane) const { return I[lane]; }
+    unsigned short getPC (int lane) const { return pc[lane]; }
+    unsigned char getDelayTimer (int lane) const { return dt[lane]; }
+    const unsigned char* getMemory (int lane) const { return &memory[(size_t) lane * 0x1000]; }
+    bool isWaitingForKey (int lane) const { return waiting[lane] != 0; }
+    bool getPixel (int lane, int x, int y) const { return (display[y * stride + lane] >> (63 - x)) & 1; }
+    //Same hash as Core::hashDisplay
+    uint64_t hashDisplay (int lane) const;
+
+private:
+    void reset ();
+    //Runs every live lane for budget instructions
+    void runBudget (int budget);
+    void execute (unsigned short address, const Instruction& instruction, uint8_t* mask);
+    //Everything that isn't worth vectorising, one lane at a time
+    void executeLane (int lane, unsigned short address, const Instruction& instruction);
+
+    unsigned short fetch (int lane, unsigned short address) const;
+    bool isCodeShared (unsigned short address) const;
+
+    int instances;
+    //Lane count rounded up to a whole number of vectors, the spare lanes are never live
+    int stride;
+
+    //[register * stride + lane]
+    std::vector<uint8_t> V;
+    std::vector<uint16_t> I;
+    std::vector<uint16_t> pc;
+    std::vector<uint8_t> sp;
+    //[level * stride + lane]
+    std::vector<uint16_t> stack;
+    std::vector<uint8_t> dt;
+    std::vector<uint8_t> st;
+    //[row * stride + lane]
+    std::vector<uint64_t> display;
+    std::vector<uint32_t> randomState;
+    //Each lane has its own 4k, [lane * 0x1000 + address]
+    std::vector<uint8_t> memory;
+
+    //0xFF for lanes still running, 0 otherwise
+    std::vector<uint8_t> live;
+    //0xFF for lanes stopped on Fx0A. They're still live, their timers tick, but with no input they never run
+    //another instruction
+    std::vector<uint8_t> waiting;
+    std::vector<uint8_t> status;
+    std::vector<uint16_t> unhandledOpcode;
+    std::vector<uint64_t> cycles;
+
+    //Instructions each lane has left in the current budget, and 0xFFFF for lanes with any left
+    std::vector<uint16_t> remaining;
+    std::vector<uint16_t> pending;
+    //Scratch masks for one instruction
+    std::vector<uint8_t> group;
+    std::vector<uint8_t> condition;
+
+    //Memory as loaded - while nobody has written to a page its code is the same in every lane
+    uint8_t image [0x1000];
+    uint64_t writtenPages;
+
+    const Instruction* decodeTable;
+    bool loaded;
+
+    int instructionRate;
+    int timerRate;
+    long instructionCredit;
+};
+
+#endif /* defined(__Chip8__Lockstep__) */
@@ -0,0 +1,140 @@
+//
+//  Pacer.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Pacer.h"
+
+#include <math.h>
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+static const uint64_t minSpinMargin = 500000;
+static const uint64_t maxSpinMargin = 4000000;
+
+Pacer::Pacer()
+{
+    rate = 60;
+    period = 1000000000ull / rate;
+    origin = 0;
+    tick = 0;
+    spinMargin = 2000000;
+    vsyncAlignment = false;
+
+    resetStats();
+}
+
+void Pacer::resetStats()
+{
+    waits = 0;
+    lateTicks = 0;
+    resyncs = 0;
+    jitterMean = 0;
+    jitterSquares = 0;
+    jitterMax = 0;
+}
+
+void Pacer::start(Timer& timer, int newRate)
+{
+    rate = newRate > 0 ? newRate : 60;
+    period = 1000000000ull / rate;
+    origin = timer.getTime();
+    tick = 1;
+}
+
+void Pacer::wait(Timer& timer)
+{
+    if (vsyncAlignment)
+        alignToVsync(timer);
+
+    uint64_t deadline = getDeadline();
+    uint64_t now = timer.getTime();
+
+    if (now > deadline + maxLag)
+    {
+        //Stalled (debugger, machine asleep, turbo) - running flat out to catch up would only make it worse
+        origin = now;
+        tick = 1;
+        resyncs++;
+        return;
+    }
+
+    if (now >= deadline)
+        lateTicks++;
+
+    if (now + spinMargin < deadline)
+    {
+        uint64_t requested = deadline - spinMargin - now;
+        timer.sleep(requested);
+
+        uint64_t slept = timer.getTime() - now;
+
+        //Sleeps that run over mean spinning for longer, ones that come back on time let it creep back down
+        if (slept > requested)
+            spinMargin = max(spinMargin - spinMargin / 64, slept - requested + minSpinMargin);
+        else
+            spinMargin -= spinMargin / 64;
+
+        spinMargin = min(max(spinMargin, minSpinMargin), maxSpinMargin);
+    }
+
+    while ((now = timer.getTime()) < deadline)
+        this_thread::yield();
+
+    uint64_t jitter = now - deadline;
+
+    waits++;
+    double difference = jitter - jitterMean;
+    jitterMean += difference / waits;
+    jitterSquares += difference * (jitter - jitterMean);
+    jitterMax = max(jitterMax, jitter);
+
+    tick++;
+
+    //Keep the sum small, the deadline only needs tick relative to origin
+    if (tick >= (uint64_t) rate)
+    {
+        origin += 1000000000ull * (tick / rate);
+        tick %= rate;
+    }
+}
+
+void Pacer::alignToVsync(Timer& timer)
+{
+    uint64_t vsync = timer.getLastVsync();
+    uint64_t deadline = getDeadline();
+
+    //Only a recent refresh says anything about where the next ones are
+    if (vsync == 0 || vsync + 4 * period < deadline || vsync > deadline + 4 * period)
+        return;
+
+    //Aim for a quarter of a period before the refresh, so the frame has time to get to the window thread
+    int64_t target = (int64_t) vsync - (int64_t) period / 4;
+    int64_t error = ((int64_t) deadline - target) % (int64_t) period;
+
+    if (error > (int64_t) period / 2)
+        error -= period;
+    else if (error < -(int64_t) period / 2)
+        error += period;
+
+    //A fraction of the error, capped so a refresh rate far from the tick rate can't drag it off
+    int64_t limit = period / 200;
+    int64_t nudge = min(max(error / 8, -limit), limit);
+
+    origin -= nudge;
+}
+
+double Pacer::getJitterMean() const
+{
+    return jitterMean / 1000.0;
+}
+
+double Pacer::getJitterDeviation() const
+{
+    return waits > 1 ? sqrt(jitterSquares / (waits - 1)) / 1000.0 : 0;
+}
@@ -0,0 +1,69 @@
+//
+//  Pacer.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Pacer__
+#define __Chip8__Pacer__
+
+#include <stdint.h>
+
+#include "Frontend.h"
+
+//Holds a loop to rate ticks a second of real time. Deadlines are worked out from when it started rather than
+//from the last wake up, so being late once doesn't push every tick after it back, and 60 Hz is 16.667ms rather than
+//16. Waits sleep most of the way and spin the rest, since sleeps only come in rough lumps
+class Pacer
+{
+public:
+    Pacer ();
+
+    //New schedule, the first deadline is one period from now
+    void start (Timer& timer, int rate);
+    //Until the next deadline. More than maxLag behind and it gives up catching up and starts again from now
+    void wait (Timer& timer);
+
+    //Nudge the deadlines towards the display's refresh (Timer::getLastVsync) so frames are finished just before
+    //it. Only pulls a little each tick, so a refresh rate close to the tick rate ends up locked to it
+    void setVsyncAlignment (bool enabled) { vsyncAlignment = enabled; }
+
+    //How late each wait woke after its deadline, in microseconds
+    double getJitterMean () const;
+    double getJitterDeviation () const;
+    double getJitterMax () const { return jitterMax / 1000.0; }
+    long getWaits () const { return waits; }
+    //Ticks that were already past their deadline before waiting
+    long getLateTicks () const { return lateTicks; }
+    //Times it fell too far behind and started over
+    long getResyncs () const { return resyncs; }
+    void resetStats ();
+
+    static const uint64_t maxLag = 100000000;
+
+private:
+    //Deadline of the current tick, exact however long it runs
+    uint64_t getDeadline () const { return origin + (tick * 1000000000ull) / rate; }
+    void alignToVsync (Timer& timer);
+
+    int rate;
+    uint64_t period;
+    uint64_t origin;
+    uint64_t tick;
+
+    //How long before the deadline to stop sleeping and spin, grows if the sleeps overshoot
+    uint64_t spinMargin;
+    bool vsyncAlignment;
+
+    long waits;
+    long lateTicks;
+    long resyncs;
+    //Running mean and squared differences for the deviation (Welford), in nanoseconds
+    double jitterMean;
+    double jitterSquares;
+    uint64_t jitterMax;
+};
+
+#endif /* defined(__Chip8__Pacer__) */
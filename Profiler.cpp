@@ -0,0 +1,268 @@
+//
+//  Profiler.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Profiler.h"
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+//Addresses listed in the reports, busiest first
+static const int hotAddressCount = 32;
+
+Profiler::Profiler()
+{
+    clear();
+}
+
+void Profiler::clear()
+{
+    memset(opCounts, 0, sizeof(opCounts));
+    memset(addressCounts, 0, sizeof(addressCounts));
+
+    //Root is whatever runs outside any call
+    nodes.clear();
+    nodes.push_back({0x200, -1, -1, -1, 0, 0, 1});
+    current = 0;
+    untracked = 0;
+
+    emulationTime = 0;
+    drawTime = 0;
+    renderTime = 0;
+    framesEmulated = 0;
+    framesRendered = 0;
+    skippedInstructions = 0;
+}
+
+void Profiler::enter(uint16_t address)
+{
+    CallNode& parent = nodes[current];
+
+    //Still counted against current, as if it were inlined. So is everything it calls, or the returns would
+    //come back in the wrong order
+    if (untracked > 0 || parent.depth >= maxDepth)
+    {
+        untracked++;
+        return;
+    }
+
+    int child = parent.firstChild;
+
+    while (child >= 0 && nodes[child].address != address)
+        child = nodes[child].nextSibling;
+
+    if (child < 0)
+    {
+        if (nodes.size() >= maxNodes)
+        {
+            untracked++;
+            return;
+        }
+
+        child = (int) nodes.size();
+        nodes.push_back({address, current, -1, parent.firstChild, parent.depth + 1, 0, 0});
+        //parent may have moved with the push_back
+        nodes[current].firstChild = child;
+    }
+
+    nodes[child].calls++;
+    current = child;
+}
+
+void Profiler::leave()
+{
+    if (untracked > 0)
+        untracked--;
+    //A return with nothing to return to is the program's business, the tree just stays at the root
+    else if (nodes[current].parent >= 0)
+        current = nodes[current].parent;
+}
+
+uint64_t Profiler::getInstructions() const
+{
+    uint64_t total = 0;
+
+    for (int op = 0; op < OP_COUNT; op++)
+        total += opCounts[op];
+
+    return total;
+}
+
+static vector<int> sortedByCount(const uint64_t* counts, int size, int limit)
+{
+    vector<int> indexes;
+
+    for (int i = 0; i < size; i++)
+    {
+        if (counts[i] > 0)
+            indexes.push_back(i);
+    }
+
+    stable_sort(indexes.begin(), indexes.end(), [counts] (int a, int b) { return counts[a] > counts[b]; });
+
+    if ((int) indexes.size() > limit)
+        indexes.resize(limit);
+
+    return indexes;
+}
+
+void Profiler::writeText(FILE* file) const
+{
+    uint64_t total = getInstructions();
+    double percent = total > 0 ? 100.0 / total : 0;
+
+    fprintf(file, "Instructions: %llu (+%llu skipped in idle loops)\n", (unsigned long long) total,
+            (unsigned long long) skippedInstructions);
+    fprintf(file, "Frames: %llu emulated, %llu rendered, %llu skipped\n", (unsigned long long) framesEmulated,
+            (unsigned long long) framesRendered, (unsigned long long) (framesEmulated - framesRendered));
+    fprintf(file, "Time: %.3f ms emulating, %.3f ms of it in DRW, %.3f ms everything else, %.3f ms rendering\n",
+            emulationTime / 1e6, drawTime / 1e6, (emulationTime - min(drawTime, emulationTime)) / 1e6, renderTime / 1e6);
+
+    fprintf(file, "\nBy op:\n");
+
+    for (int op : sortedByCount(opCounts, OP_COUNT, OP_COUNT))
+        fprintf(file, "  %-12s %14llu %6.2f%%\n", getOpName((Op) op), (unsigned long long) opCounts[op], opCounts[op] * percent);
+
+    fprintf(file, "\nHottest addresses:\n");
+
+    for (int address : sortedByCount(addressCounts, 0x10000, hotAddressCount))
+        fprintf(file, "  %03X %14llu %6.2f%%\n", address, (unsigned long long) addressCounts[address],
+                addressCounts[address] * percent);
+
+    fprintf(file, "\nCall tree (own instructions, calls):\n");
+
+    //Depth first. Children are kept newest first, so pushed in that order they come off oldest first
+    vector<int> stack = {0};
+
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        const CallNode& node = nodes[index];
+
+        fprintf(file, "  %*s%03X %llu %llu\n", node.depth * 2, "", node.address, (unsigned long long) node.instructions,
+                (unsigned long long) node.calls);
+
+        for (int child = node.firstChild; child >= 0; child = nodes[child].nextSibling)
+            stack.push_back(child);
+    }
+}
+
+void Profiler::writeJsonNode(FILE* file, int index, int indent) const
+{
+    const CallNode& node = nodes[index];
+
+    fprintf(file, "%*s{\"address\": %u, \"instructions\": %llu, \"calls\": %llu, \"children\": [", indent, "",
+            node.address, (unsigned long long) node.instructions, (unsigned long long) node.calls);
+
+    if (node.firstChild < 0)
+    {
+        fprintf(file, "]}");
+        return;
+    }
+
+    fprintf(file, "\n");
+
+    for (int child = node.firstChild; child >= 0; child = nodes[child].nextSibling)
+    {
+        writeJsonNode(file, child, indent + 2);
+        fprintf(file, nodes[child].nextSibling >= 0 ? ",\n" : "\n");
+    }
+
+    fprintf(file, "%*s]}", indent, "");
+}
+
+void Profiler::writeJson(FILE* file) const
+{
+    fprintf(file, "{\n");
+    fprintf(file, "  \"instructions\": %llu,\n", (unsigned long long) getInstructions());
+    fprintf(file, "  \"idleSkipped\": %llu,\n", (unsigned long long) skippedInstructions);
+    fprintf(file, "  \"frames\": {\"emulated\": %llu, \"rendered\": %llu},\n", (unsigned long long) framesEmulated,
+            (unsigned long long) framesRendered);
+    fprintf(file, "  \"nanoseconds\": {\"emulation\": %llu, \"draw\": %llu, \"render\": %llu},\n",
+            (unsigned long long) emulationTime, (unsigned long long) drawTime, (unsigned long long) renderTime);
+
+    fprintf(file, "  \"ops\": {");
+    bool first = true;
+
+    for (int op = 0; op < OP_COUNT; op++)
+    {
+        if (opCounts[op] == 0)
+            continue;
+
+        fprintf(file, "%s\"%s\": %llu", first ? "" : ", ", getOpName((Op) op), (unsigned long long) opCounts[op]);
+        first = false;
+    }
+
+    fprintf(file, "},\n  \"addresses\": {");
+    first = true;
+
+    for (int address = 0; address < 0x10000; address++)
+    {
+        if (addressCounts[address] == 0)
+            continue;
+
+        fprintf(file, "%s\"%03X\": %llu", first ? "" : ", ", address, (unsigned long long) addressCounts[address]);
+        first = false;
+    }
+
+    fprintf(file, "},\n  \"callTree\":\n");
+    writeJsonNode(file, 0, 2);
+    fprintf(file, "\n}\n");
+}
+
+void Profiler::writePath(FILE* file, int index) const
+{
+    if (nodes[index].parent >= 0)
+    {
+        writePath(file, nodes[index].parent);
+        fprintf(file, ";");
+    }
+
+    fprintf(file, "%03X", nodes[index].address);
+}
+
+void Profiler::writeFolded(FILE* file) const
+{
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i].instructions == 0)
+            continue;
+
+        writePath(file, (int) i);
+        fprintf(file, " %llu\n", (unsigned long long) nodes[i].instructions);
+    }
+}
+
+bool Profiler::save(const char* prefix) const
+{
+    string base = prefix;
+    const char* extensions [] = {".txt", ".json", ".folded"};
+
+    for (int i = 0; i < 3; i++)
+    {
+        FILE* file = fopen((base + extensions[i]).c_str(), "w");
+
+        if (file == nullptr)
+            return false;
+
+        if (i == 0)
+            writeText(file);
+        else if (i == 1)
+            writeJson(file);
+        else
+            writeFolded(file);
+
+        if (fclose(file) != 0)
+            return false;
+    }
+
+    return true;
+}
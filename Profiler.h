@@ -0,0 +1,104 @@
+//
+//  Profiler.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Profiler__
+#define __Chip8__Profiler__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+#include "Decode.h"
+
+//Where a ROM spends its time - executions per op and per address, a call tree from 2NNN/00EE, time in DRW against
+//everything else and how many frames got drawn. The Core only calls into it when built with CHIP8_PROFILE, without
+//that the hooks aren't there at all and setProfiler does nothing
+class Profiler
+{
+public:
+    Profiler ();
+    void clear ();
+
+    //Hooks from the Core, before each instruction runs
+    void instruction (uint16_t address, const Instruction& instruction)
+    {
+        opCounts[instruction.op]++;
+        addressCounts[address]++;
+        nodes[current].instructions++;
+
+        if (instruction.op == OP_CALL)
+            enter(instruction.nnn);
+        else if (instruction.op == OP_RET)
+            leave();
+    }
+
+    void addEmulationTime (uint64_t nanoseconds) { emulationTime += nanoseconds; }
+    void addDrawTime (uint64_t nanoseconds) { drawTime += nanoseconds; }
+    void addRenderTime (uint64_t nanoseconds) { renderTime += nanoseconds; }
+    void frameEmulated () { framesEmulated++; }
+    void frameRendered () { framesRendered++; }
+    //Instructions idle loop skipping counted without running
+    void idleSkipped (uint64_t count) { skippedInstructions += count; }
+
+    static uint64_t now ()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void writeText (FILE* file) const;
+    void writeJson (FILE* file) const;
+    //Folded stacks, one line per call path with its own instruction count - what flamegraph.pl takes
+    void writeFolded (FILE* file) const;
+    //prefix.txt, prefix.json and prefix.folded
+    bool save (const char* prefix) const;
+
+    uint64_t getInstructions () const;
+
+private:
+    struct CallNode
+    {
+        uint16_t address;
+        int parent;
+        int firstChild;
+        int nextSibling;
+        int depth;
+        //Run while this was the innermost call, and times it was called
+        uint64_t instructions;
+        uint64_t calls;
+    };
+
+    void enter (uint16_t address);
+    void leave ();
+    void writeJsonNode (FILE* file, int index, int indent) const;
+    void writePath (FILE* file, int index) const;
+
+    //Same as the Chip8 stack, deeper calls have overwritten their return address anyway
+    static const int maxDepth = 16;
+    //Code that calls and jumps out without returning can make paths forever, stop adding them after this
+    static const size_t maxNodes = 1 << 16;
+
+    uint64_t opCounts [OP_COUNT];
+    //All of XO-CHIP's 64K
+    uint64_t addressCounts [0x10000];
+
+    std::vector<CallNode> nodes;
+    int current;
+    //Calls below current that got no node of their own (too deep, or out of nodes). Their returns come back
+    //to current, they mustn't take it up to its parent
+    int untracked;
+
+    uint64_t emulationTime;
+    uint64_t drawTime;
+    uint64_t renderTime;
+    uint64_t framesEmulated;
+    uint64_t framesRendered;
+    uint64_t skippedInstructions;
+};
+
+#endif /* defined(__Chip8__Profiler__) */
@@ -0,0 +1,162 @@
+//
+//  Quirks.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Quirks.h"
+#include "Hash.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+//Same order as the bits in Quirk
+static const char* const quirkNames [] = { "shift", "memory", "jump", "clip", "vfreset" };
+static const int quirkNameCount = sizeof(quirkNames) / sizeof(quirkNames[0]);
+
+uint8_t getDefaultQuirks(Mode mode)
+{
+    switch (mode)
+    {
+        //SUPER-CHIP 1.1 on the HP48
+        case MODE_SCHIP:
+            return QUIRK_JUMP_VX | QUIRK_CLIP;
+        //Octo
+        case MODE_XOCHIP:
+            return QUIRK_MEMORY_INCREMENT;
+        default:
+            return 0;
+    }
+}
+
+string formatQuirks(uint8_t quirks)
+{
+    string list;
+
+    for (int i = 0; i < quirkNameCount; i++)
+    {
+        if ((quirks & (1 << i)) == 0)
+            continue;
+
+        if (!list.empty())
+            list += ",";
+
+        list += quirkNames[i];
+    }
+
+    return list.empty() ? "none" : list;
+}
+
+bool parseQuirks(const char* list, uint8_t& quirks)
+{
+    uint8_t parsed = 0;
+    stringstream stream(list);
+    string name;
+
+    while (getline(stream, name, ','))
+    {
+        if (name == "none")
+            continue;
+
+        const char* const* found = find_if(quirkNames, quirkNames + quirkNameCount, [&] (const char* quirk) { return name == quirk; });
+
+        if (found == quirkNames + quirkNameCount)
+            return false;
+
+        parsed |= 1 << (found - quirkNames);
+    }
+
+    quirks = parsed;
+    return true;
+}
+
+uint64_t hashROM(const unsigned char* data, size_t size)
+{
+    return fnv1a(data, size);
+}
+
+bool parseROMHash(const string& text, uint64_t& romHash)
+{
+    //strtoull would stop quietly at the first bad digit, or take a short one, and the ROM would never be found
+    if (text.size() != 16 || !all_of(text.begin(), text.end(), [] (char c) { return isxdigit((unsigned char) c) != 0; }))
+        return false;
+
+    romHash = strtoull(text.c_str(), nullptr, 16);
+    return true;
+}
+
+bool QuirkDatabase::load(const char* location)
+{
+    ifstream file(location);
+
+    if (!file.is_open())
+        return false;
+
+    string line;
+    int number = 0;
+
+    while (getline(file, line))
+    {
+        number++;
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        stringstream fields(line);
+        string hash, list;
+        uint64_t romHash;
+        uint8_t quirks;
+
+        fields >> hash >> list;
+
+        if (!parseROMHash(hash, romHash) || list.empty() || !parseQuirks(list.c_str(), quirks))
+        {
+            fprintf(stderr, "%s:%d: expected \"hash quirks\" with a 16 digit hex hash\n", location, number);
+            return false;
+        }
+
+        entries[romHash] = quirks;
+    }
+
+    return true;
+}
+
+bool QuirkDatabase::save(const char* location) const
+{
+    FILE* file = fopen(location, "w");
+
+    if (file == nullptr)
+        return false;
+
+    //Sorted so the file diffs cleanly
+    vector<pair<uint64_t, uint8_t>> sorted(entries.begin(), entries.end());
+    sort(sorted.begin(), sorted.end());
+
+    fprintf(file, "#rom hash\tquirks (%s or none)\n", formatQuirks(quirkCombinations - 1).c_str());
+
+    for (const pair<uint64_t, uint8_t>& entry : sorted)
+        fprintf(file, "%016llx\t%s\n", (unsigned long long) entry.first, formatQuirks(entry.second).c_str());
+
+    return fclose(file) == 0;
+}
+
+bool QuirkDatabase::find(uint64_t romHash, uint8_t& quirks) const
+{
+    auto found = entries.find(romHash);
+
+    if (found == entries.end())
+        return false;
+
+    quirks = found->second;
+    return true;
+}
@@ -0,0 +1,65 @@
+//
+//  Quirks.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Quirks__
+#define __Chip8__Quirks__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+
+#include "Decode.h"
+
+//Behaviour that differs between CHIP-8 interpreters, which ROMs were written against. Bits, so every combination is a
+//single number the interpreter is compiled for - none of them are checked while instructions run
+enum Quirk : uint8_t
+{
+    //8XY6 / 8XYE shift VY into VX instead of shifting VX
+    QUIRK_SHIFT_VY = 1 << 0,
+    //FX55 / FX65 leave I just past the last register
+    QUIRK_MEMORY_INCREMENT = 1 << 1,
+    //BXNN jumps to XNN + VX instead of BNNN to NNN + V0
+    QUIRK_JUMP_VX = 1 << 2,
+    //Sprites are cut off at the edges of the display instead of wrapping
+    QUIRK_CLIP = 1 << 3,
+    //8XY1 / 8XY2 / 8XY3 clear VF
+    QUIRK_VF_RESET = 1 << 4
+};
+
+static const int quirkCombinations = 1 << 5;
+
+//What the usual interpreter for each mode does - nothing for CHIP-8, which is how this one has always run it
+uint8_t getDefaultQuirks (Mode mode);
+//Comma separated names, "shift,clip". "none" for no quirks
+std::string formatQuirks (uint8_t quirks);
+bool parseQuirks (const char* list, uint8_t& quirks);
+
+//FNV-1a over the ROM file, what ROMs are looked up by
+uint64_t hashROM (const unsigned char* data, size_t size);
+//A hash the way the database and RomIndex write them, all 16 hex digits. false for anything else
+bool parseROMHash (const std::string& text, uint64_t& romHash);
+
+//Quirks per ROM, kept as a text file of "hash quirks" lines with # comments. The only place they're kept, RomIndex
+//leaves them to this
+class QuirkDatabase
+{
+public:
+    bool load (const char* location);
+    bool save (const char* location) const;
+
+    //false if the ROM isn't in it
+    bool find (uint64_t romHash, uint8_t& quirks) const;
+    void set (uint64_t romHash, uint8_t quirks) { entries[romHash] = quirks; }
+    size_t size () const { return entries.size(); }
+
+private:
+    std::unordered_map<uint64_t, uint8_t> entries;
+};
+
+#endif /* defined(__Chip8__Quirks__) */
@@ -0,0 +1,375 @@
+//
+//  Recompiler.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Recompiler.h"
+#include "Core.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(_WIN32)
+#define CHIP8_NATIVE_RECOMPILER 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+//Longest run compiled into one block
+static const int maxBlockLength = 64;
+//Room kept free in the code buffer - more than the largest block can use
+static const size_t codeReserve = 64 * 32 + 64;
+
+Recompiler::Recompiler (Core& owner, bool allowNative) : core(owner), blocks(0x1000), pageBlocks(0x1000 >> pageShift)
+{
+    codeBuffer = nullptr;
+    codeSize = 0;
+    codeUsed = 0;
+    native = false;
+
+#ifdef CHIP8_NATIVE_RECOMPILER
+    if (allowNative)
+    {
+        codeSize = 1024 * 1024;
+        //Never writable and executable at once - protectCode opens up just the pages a block is emitted into
+        void* buffer = mmap(nullptr, codeSize, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (buffer != MAP_FAILED)
+        {
+            codeBuffer = (uint8_t*) buffer;
+            native = true;
+        }
+        else
+            //Host won't give us the memory - closure chains still work
+            codeSize = 0;
+    }
+#endif
+}
+
+Recompiler::~Recompiler()
+{
+#ifdef CHIP8_NATIVE_RECOMPILER
+    if (codeBuffer != nullptr)
+        munmap(codeBuffer, codeSize);
+#endif
+}
+
+void Recompiler::run (int count)
+{
+    retired.clear();
+
+    //An Fx0A that finds no key stops the frame - it always ends a block, so that's only ever between blocks
+    while (count > 0 && !core.waitingForKey)
+    {
+        unsigned short pc = core.pc;
+
+        //Anything that could wrap around memory goes through the interpreter, as does all of XO-CHIP's memory
+        //past the first 4K
+        Block* block = pc < 0xFFF ? blocks[pc].get() : nullptr;
+
+        if (block == nullptr && pc < 0xFFF)
+            block = compile(pc);
+
+        if (block == nullptr)
+        {
+            core.emulateCycle();
+            count--;
+            continue;
+        }
+        
+        if (block->length > count)
+        {
+            //Only the last step of a block looks at pc, so the front of it can run from the handler chain
+            core.pc = block->start + 2 * count;
+            core.cycles += count;
+            
+            for (int i = 0; i < count; i++)
+                (core.*block->steps[i].handler)(*block->steps[i].instruction);
+            
+            return;
+        }
+
+        //pc already points past the block, so the handler at the end sees the same pc the interpreter would give it
+        core.pc = block->end;
+        core.cycles += block->length;
+        count -= block->length;
+
+        if (native && block->code != nullptr)
+            block->code(core.registers, &core.I, &core);
+        else
+        {
+            for (const Step& step : block->steps)
+                (core.*step.handler)(*step.instruction);
+        }
+
+        //An Fx33 / Fx55 at the end of the block might have just invalidated it
+        if (!retired.empty())
+            retired.clear();
+    }
+}
+
+void Recompiler::invalidate (unsigned short address, int length)
+{
+    //Wrapped the same way the Core wraps the write. Blocks are only ever in the first 4K, XO-CHIP's pages past it
+    //have nothing to drop
+    int pageCount = (core.addressMask + 1) >> pageShift;
+    int firstPage = (address & core.addressMask) >> pageShift;
+    int lastPage = ((address + length - 1) & core.addressMask) >> pageShift;
+
+    for (int page = firstPage; ; page = (page + 1) % pageCount)
+    {
+        if (page < (int) pageBlocks.size())
+        {
+            for (unsigned short start : pageBlocks[page])
+            {
+                if (blocks[start] != nullptr)
+                    retired.push_back(move(blocks[start]));
+            }
+
+            pageBlocks[page].clear();
+        }
+
+        if (page == lastPage)
+            break;
+    }
+}
+
+void Recompiler::flush ()
+{
+    for (unique_ptr<Block>& block : blocks)
+    {
+        if (block != nullptr)
+            retired.push_back(move(block));
+    }
+
+    for (vector<unsigned short>& page : pageBlocks)
+        page.clear();
+
+    //Never called from inside a block, so none of the native code can still be running
+    codeUsed = 0;
+}
+
+bool Recompiler::endsBlock (Op op)
+{
+    switch (op)
+    {
+        //Change or read pc
+        case OP_RET:
+        case OP_JP:
+        case OP_CALL:
+        case OP_JP_V0:
+        case OP_SE_BYTE:
+        case OP_SNE_BYTE:
+        case OP_SE_REG:
+        case OP_SNE_REG:
+        case OP_SKP:
+        case OP_SKNP:
+        case OP_LD_VX_K:
+        case OP_UNHANDLED:
+        case OP_LD_I_LONG:
+        case OP_EXIT:
+        //Presentation happens between blocks
+        case OP_DRW:
+        case OP_SCD:
+        case OP_SCU:
+        case OP_SCR:
+        case OP_SCL:
+        case OP_LOW:
+        case OP_HIGH:
+        //Write memory, which might be this block
+        case OP_LD_B:
+        case OP_LD_MEM:
+        case OP_SAVE_RANGE:
+        //Needs its position in the frame for the audio, which is only known between blocks
+        case OP_LD_ST:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Recompiler::Block* Recompiler::compile (unsigned short address)
+{
+    //Out of room for native code - start again, only ever called between blocks
+    if (native && codeSize - codeUsed < codeReserve)
+        flush();
+
+    unique_ptr<Block> block(new Block());
+    block->start = address;
+    block->code = nullptr;
+
+    //Whichever mode and quirks the Core has now, changing either flushes everything
+    const Instruction* decodeTable = core.decodeTable;
+    unsigned short pc = address;
+
+    while (block->steps.size() < maxBlockLength && pc < 0xFFF)
+    {
+        const Instruction* instruction = &decodeTable[(core.memory[pc] << 8) | core.memory[pc + 1]];
+
+        block->steps.push_back({ core.handlers[instruction->op], instruction });
+        pc += 2;
+
+        if (endsBlock(instruction->op))
+            break;
+    }
+
+    block->end = pc;
+    block->length = (int) block->steps.size();
+
+    //Steps are kept even with native code, for when only part of the block fits in a frame
+    if (native)
+    {
+        size_t offset = codeUsed;
+
+        if (protectCode(offset, codeReserve, true))
+        {
+            emitNative(*block);
+            protectCode(offset, codeReserve, false);
+        }
+    }
+
+    for (int page = address >> pageShift; page <= ((pc - 1) >> pageShift); page++)
+        pageBlocks[page].push_back(address);
+
+    blocks[address] = move(block);
+    return blocks[address].get();
+}
+
+bool Recompiler::protectCode (size_t offset, size_t size, bool writable)
+{
+#ifdef CHIP8_NATIVE_RECOMPILER
+    //Whole pages, and no more of them than the range touches - flipping the entire buffer on every compile costs
+    //more than the native code saves
+    size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    size_t first = offset & ~(pageSize - 1);
+    size_t end = offset + size < codeSize ? offset + size : codeSize;
+    size_t last = (end + pageSize - 1) & ~(pageSize - 1);
+
+    if (mprotect(codeBuffer + first, last - first, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) != 0)
+    {
+        //Hardened hosts can refuse to make memory that's been written executable - closure chains from now on
+        native = false;
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void Recompiler::executeHelper (Core* core, const Instruction* instruction)
+{
+    core->execute(*instruction);
+}
+
+void Recompiler::emit (const uint8_t* bytes, size_t count)
+{
+    memcpy(codeBuffer + codeUsed, bytes, count);
+    codeUsed += count;
+}
+
+void Recompiler::emit64 (uint64_t value)
+{
+    emit((const uint8_t*) &value, sizeof(value));
+}
+
+//x86-64 System V. Called as code(registers, &I, core) - those are kept in rbx, r12 and r13 across helper calls.
+//The simple register ops are emitted inline, everything else calls back into the interpreter's handler
+bool Recompiler::emitNative (Block& block)
+{
+#ifdef CHIP8_NATIVE_RECOMPILER
+    uint8_t* start = codeBuffer + codeUsed;
+
+    //push rbx, push r12, push r13 - leaves the stack 16 byte aligned for calls
+    //mov rbx, rdi   mov r12, rsi   mov r13, rdx
+    const uint8_t prologue [] = { 0x53, 0x41, 0x54, 0x41, 0x55, 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4, 0x49, 0x89, 0xD5 };
+    emit(prologue, sizeof(prologue));
+
+    for (const Step& step : block.steps)
+    {
+        const Instruction& instruction = *step.instruction;
+        uint8_t x = instruction.x;
+        uint8_t y = instruction.y;
+
+        switch (instruction.op)
+        {
+            case OP_LD_BYTE:
+            {
+                //mov byte [rbx + x], nn
+                const uint8_t code [] = { 0xC6, 0x43, x, instruction.nn };
+                emit(code, sizeof(code));
+                break;
+            }
+            case OP_ADD_BYTE:
+            {
+                //add byte [rbx + x], nn
+                const uint8_t code [] = { 0x80, 0x43, x, instruction.nn };
+                emit(code, sizeof(code));
+                break;
+            }
+            case OP_LD_REG:
+            case OP_OR:
+            case OP_AND:
+            case OP_XOR:
+            {
+                //mov al, [rbx + y] then mov / or / and / xor [rbx + x], al
+                const uint8_t ops [] = { 0x88, 0x08, 0x20, 0x30 };
+                const uint8_t code [] = { 0x8A, 0x43, y, ops[instruction.op - OP_LD_REG], 0x43, x };
+                emit(code, sizeof(code));
+
+                if (instruction.op != OP_LD_REG && (core.quirks & QUIRK_VF_RESET))
+                {
+                    //mov byte [rbx + 0xF], 0
+                    const uint8_t reset [] = { 0xC6, 0x43, 0x0F, 0x00 };
+                    emit(reset, sizeof(reset));
+                }
+                break;
+            }
+            case OP_ADD_REG:
+            {
+                //movzx eax, byte [rbx + x]   movzx ecx, byte [rbx + y]   add eax, ecx
+                //mov edx, eax   shr edx, 8   mov [rbx + 0xF], dl   mov [rbx + x], al
+                //VF first so Vx wins when x is F, same as the interpreter
+                const uint8_t code [] = {
+                    0x0F, 0xB6, 0x43, x, 0x0F, 0xB6, 0x4B, y, 0x01, 0xC8,
+                    0x89, 0xC2, 0xC1, 0xEA, 0x08, 0x88, 0x53, 0x0F, 0x88, 0x43, x
+                };
+                emit(code, sizeof(code));
+                break;
+            }
+            case OP_LD_I:
+            {
+                //mov word [r12], nnn
+                const uint8_t code [] = { 0x66, 0x41, 0xC7, 0x04, 0x24, (uint8_t) (instruction.nnn & 0xFF), (uint8_t) (instruction.nnn >> 8) };
+                emit(code, sizeof(code));
+                break;
+            }
+            default:
+            {
+                //mov rdi, r13   mov rsi, instruction   mov rax, executeHelper   call rax
+                const uint8_t moveCore [] = { 0x4C, 0x89, 0xEF };
+                emit(moveCore, sizeof(moveCore));
+                emit8(0x48);
+                emit8(0xBE);
+                emit64((uint64_t) step.instruction);
+                emit8(0x48);
+                emit8(0xB8);
+                emit64((uint64_t) &Recompiler::executeHelper);
+                emit8(0xFF);
+                emit8(0xD0);
+                break;
+            }
+        }
+    }
+
+    //pop r13, pop r12, pop rbx, ret
+    const uint8_t epilogue [] = { 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3 };
+    emit(epilogue, sizeof(epilogue));
+
+    block.code = (NativeBlock) start;
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,89 @@
+//
+//  Recompiler.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Recompiler__
+#define __Chip8__Recompiler__
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "Decode.h"
+
+class Core;
+
+//Block caching recompiler. Straight line runs of instructions ending at a jump, skip, call, draw or memory
+//write are compiled once and then run as a unit - x86-64 machine code where we can, otherwise a chain of
+//pre-decoded handler calls
+class Recompiler
+{
+public:
+    Recompiler (Core& owner, bool allowNative);
+    ~Recompiler();
+
+    //Runs exactly count instructions, a block that doesn't fit in what's left is single stepped
+    void run (int count);
+
+    //Fx33 / Fx55 / 5XY2 wrote [address, address + length), drop any block covering it
+    void invalidate (unsigned short address, int length);
+    //Everything goes - new ROM or reset
+    void flush ();
+
+    bool isNative () const { return native; }
+
+private:
+    typedef void (*NativeBlock) (unsigned char* registers, unsigned short* I, Core* core);
+
+    struct Step
+    {
+        void (Core::*handler) (const Instruction& instruction);
+        const Instruction* instruction;
+    };
+
+    struct Block
+    {
+        unsigned short start;
+        unsigned short end;
+        int length;
+
+        //Native code if there is any, the steps are always there
+        NativeBlock code;
+        std::vector<Step> steps;
+    };
+
+    Block* compile (unsigned short address);
+    bool emitNative (Block& block);
+    void emit (const uint8_t* bytes, size_t count);
+    void emit8 (uint8_t value) { emit(&value, 1); }
+    void emit64 (uint64_t value);
+    //Turns the pages under size bytes of the code buffer from offset writable for emitting, or back to executable.
+    //false if the host won't allow it, native code is given up on from then
+    bool protectCode (size_t offset, size_t size, bool writable);
+
+    static bool endsBlock (Op op);
+    static void executeHelper (Core* core, const Instruction* instruction);
+
+    Core& core;
+    bool native;
+
+    //Indexed by start address
+    std::vector<std::unique_ptr<Block>> blocks;
+    //Invalidated blocks can still be running (the Fx55 that killed them is their last step), freed next run
+    std::vector<std::unique_ptr<Block>> retired;
+
+    //Start addresses of the blocks touching each 64 byte page
+    static const int pageShift = 6;
+    std::vector<std::vector<unsigned short>> pageBlocks;
+
+    //Memory for native blocks, bump allocated and only ever released all at once
+    uint8_t* codeBuffer;
+    size_t codeSize;
+    size_t codeUsed;
+};
+
+#endif /* defined(__Chip8__Recompiler__) */
@@ -0,0 +1,847 @@
+//
+//  ReferenceCore.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "ReferenceCore.h"
+#include "Font.h"
+#include "Hash.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+
+using namespace std;
+
+ReferenceCore::ReferenceCore () : input(nullptr)
+{
+    seed(0);
+
+    instructionRate = 540;
+    timerRate = 60;
+
+    setMode(MODE_CHIP8);
+}
+
+void ReferenceCore::setMode(Mode newMode)
+{
+    mode = newMode;
+    memorySize = mode == MODE_XOCHIP ? 0x10000 : 0x1000;
+    addressMask = memorySize - 1;
+    quirks = getDefaultQuirks(mode);
+
+    reset();
+}
+
+void ReferenceCore::reset()
+{
+    memset(memory, 0, sizeof(memory));
+    memset(registers, 0, sizeof(registers));
+    memset(stack, 0, sizeof(stack));
+    memset(display, 0, sizeof(display));
+    memset(flags, 0, sizeof(flags));
+    memset(pattern, 0xF0, sizeof(pattern));
+
+    displayWidth = 64;
+    displayHeight = 32;
+    planeMask = 1;
+    pitch = 64;
+
+    I = 0;
+    pc = 0x200;
+    sp = 0;
+    st = 0;
+    dt = 0;
+
+    cycles = 0;
+    instructionCredit = 0;
+
+    status = STATUS_RUNNING;
+    unhandledOpcode = 0;
+    waitingForKey = false;
+    keyRegister = 0;
+
+    memcpy(memory, smallFont, sizeof(smallFont));
+
+    if (mode != MODE_CHIP8)
+        memcpy(&memory[bigFontStart], bigFont, sizeof(bigFont));
+
+    romHash = 0;
+}
+
+bool ReferenceCore::loadROM(const unsigned char* data, size_t size)
+{
+    if (size > memorySize - 0x200)
+    {
+        cerr << "ROM too large " << size << " bytes" << endl;
+        return false;
+    }
+
+    memcpy(&memory[0x200], data, size);
+    romHash = hashROM(data, size);
+
+    return true;
+}
+
+void ReferenceCore::packDisplay(uint64_t* words) const
+{
+    int rowWords = displayWidth / 64;
+
+    for (int plane = 0; plane < getDisplayPlanes(); plane++)
+    {
+        for (int y = 0; y < displayHeight; y++)
+        {
+            for (int x = 0; x < displayWidth; x++)
+            {
+                uint64_t& word = words[(plane * displayHeight + y) * rowWords + x / 64];
+                uint64_t bit = 1ull << (63 - x % 64);
+
+                if (display[(y * displayWidth) + x] & (1 << plane))
+                    word |= bit;
+                else
+                    word &= ~bit;
+            }
+        }
+    }
+}
+
+uint64_t ReferenceCore::hashDisplay() const
+{
+    uint64_t words [Core::maxPlanes * Core::maxDisplayHeight * Core::maxDisplayWidth / 64];
+
+    packDisplay(words);
+
+    return fnv1a(words, getDisplayPlanes() * displayHeight * (displayWidth / 64) * sizeof(uint64_t));
+}
+
+void ReferenceCore::saveState(Snapshot& snapshot) const
+{
+    size_t displaySize = getDisplayPlanes() * displayHeight * (displayWidth / 64) * sizeof(uint64_t);
+
+    //All of it, padding included, the same as Core::saveState leaves it
+    memset(&snapshot, 0, offsetof(Snapshot, memory));
+    memset(snapshot.memory + memorySize, 0, sizeof(snapshot.memory) - memorySize);
+
+    snapshot.magic = Snapshot::magicValue;
+    snapshot.version = Snapshot::currentVersion;
+    snapshot.size = sizeof(Snapshot);
+    snapshot.randomState = randomState;
+    snapshot.memorySize = (uint32_t) memorySize;
+    snapshot.displaySize = (uint32_t) displaySize;
+
+    memcpy(snapshot.memory, memory, memorySize);
+    memcpy(snapshot.registers, registers, sizeof(registers));
+    memcpy(snapshot.stack, stack, sizeof(stack));
+    snapshot.I = I;
+    snapshot.pc = pc;
+    snapshot.sp = sp;
+    snapshot.dt = dt;
+    snapshot.st = st;
+    snapshot.status = status;
+    snapshot.unhandledOpcode = unhandledOpcode;
+    snapshot.waitingForKey = waitingForKey;
+    snapshot.keyRegister = keyRegister;
+
+    snapshot.mode = mode;
+    snapshot.hires = displayWidth == Core::maxDisplayWidth;
+    snapshot.planeMask = planeMask;
+    snapshot.pitch = pitch;
+    snapshot.quirks = quirks;
+    memcpy(snapshot.flags, flags, sizeof(flags));
+    memcpy(snapshot.pattern, pattern, sizeof(pattern));
+
+    packDisplay(snapshot.display);
+    snapshot.cycles = cycles;
+    snapshot.instructionCredit = instructionCredit;
+}
+
+bool ReferenceCore::loadState(const Snapshot& snapshot)
+{
+    if (!snapshot.isValid() || snapshot.mode >= MODE_COUNT)
+        return false;
+
+    if (snapshot.mode != mode)
+        setMode((Mode) snapshot.mode);
+
+    setQuirks(snapshot.quirks);
+
+    memcpy(memory, snapshot.memory, memorySize);
+    memcpy(registers, snapshot.registers, sizeof(registers));
+    memcpy(stack, snapshot.stack, sizeof(stack));
+    I = snapshot.I;
+    pc = snapshot.pc;
+    sp = snapshot.sp;
+    dt = snapshot.dt;
+    st = snapshot.st;
+    status = (Status) snapshot.status;
+    unhandledOpcode = snapshot.unhandledOpcode;
+    waitingForKey = snapshot.waitingForKey != 0;
+    keyRegister = snapshot.keyRegister & 0xF;
+
+    displayWidth = snapshot.hires ? Core::maxDisplayWidth : 64;
+    displayHeight = snapshot.hires ? Core::maxDisplayHeight : 32;
+    planeMask = snapshot.planeMask & ((1 << Core::maxPlanes) - 1);
+    pitch = snapshot.pitch;
+    memcpy(flags, snapshot.flags, sizeof(flags));
+    memcpy(pattern, snapshot.pattern, sizeof(pattern));
+
+    int rowWords = displayWidth / 64;
+    memset(display, 0, sizeof(display));
+
+    for (int plane = 0; plane < getDisplayPlanes(); plane++)
+    {
+        for (int y = 0; y < displayHeight; y++)
+        {
+            for (int x = 0; x < displayWidth; x++)
+            {
+                if ((snapshot.display[(plane * displayHeight + y) * rowWords + x / 64] >> (63 - x % 64)) & 1)
+                    disp(x, y) |= 1 << plane;
+            }
+        }
+    }
+
+    cycles = snapshot.cycles;
+    instructionCredit = snapshot.instructionCredit;
+    randomState = snapshot.randomState;
+
+    return true;
+}
+
+void ReferenceCore::seed(uint32_t value)
+{
+    randomState = value != 0 ? value : 0x9E3779B9;
+}
+
+unsigned char ReferenceCore::random()
+{
+    //xorshift32, the Core's CXNN sequence
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState >> 24;
+}
+
+void ReferenceCore::emulateFrame()
+{
+    //Whole instructions for this tick, the remainder carries into the next
+    instructionCredit += instructionRate;
+    int count = (int) (instructionCredit / timerRate);
+    instructionCredit -= (long) count * timerRate;
+
+    if (waitingForKey)
+    {
+        int key = input != nullptr ? input->getKeyPress() : -1;
+
+        if (key >= 0)
+        {
+            registers[keyRegister] = key & 0xF;
+            pc += 2;
+            waitingForKey = false;
+        }
+    }
+
+    if (!waitingForKey)
+        emulateCycles(count);
+
+    //Update timers
+    if (dt > 0)
+        dt--;
+
+    if (st > 0)
+        st--;
+}
+
+void ReferenceCore::emulateCycles(int count)
+{
+    for (int i = 0; i < count && !waitingForKey; i++)
+        emulateCycle();
+}
+
+unsigned short ReferenceCore::getHex (unsigned short opcode, uint8_t position, uint8_t length)
+{
+    //Size of the opcode not including position 0
+    const uint8_t opcodeSize = 4;
+
+    assert(length > 0);
+    //Position starts at 0, must be between 0-3
+    assert(position <= opcodeSize);
+    //Position + length must be less than size of the opcode
+    assert((position + length) <= opcodeSize);
+
+    //Returns the value at (position) in opcode, value will be (length) nibbles long
+    int mask = 0x0;
+    int addedCount = 0;
+
+    for (int i = 0; i < opcodeSize; i++)
+    {
+        if (i >= position && addedCount < length)
+        {
+            mask |= (0xf << ((opcodeSize - 1) - i) * 4);
+            addedCount++;
+        }
+    }
+
+    return (opcode & mask) >> ((opcodeSize - (position + length)) * 4);
+}
+
+void ReferenceCore::emulateCycle()
+{
+    //Opcodes are 16-bit - put together memory[pc] + memory[pc + 1]
+    unsigned short opcode = (memory[pc & addressMask] << 8) | memory[(pc + 1) & addressMask];
+
+    pc += 2;
+    cycles++;
+
+    //Most opcodes are based on the first character
+    switch (getHex(opcode, 0, 1))
+    {
+        case 0x0:
+            hex0(opcode);
+            break;
+        case 0x1:
+        case 0x2:
+            goToAddress(opcode);
+            break;
+        case 0x3:
+        case 0x4:
+        case 0x9:
+            skipNextInstruction(opcode);
+            break;
+        case 0x5:
+            hex5(opcode);
+            break;
+        case 0x6:
+            hex6(opcode);
+            break;
+        case 0x7:
+            hex7(opcode);
+            break;
+        case 0x8:
+            hex8(opcode);
+            break;
+        case 0xA:
+            hexA(opcode);
+            break;
+        case 0xB:
+            hexB(opcode);
+            break;
+        case 0xC:
+            hexC(opcode);
+            break;
+        case 0xD:
+            hexD(opcode);
+            break;
+        case 0xE:
+            hexE(opcode);
+            break;
+        case 0xF:
+            hexF(opcode);
+            break;
+    }
+}
+
+void ReferenceCore::unhandled(unsigned short opcode)
+{
+    pc -= 2;
+    unhandledOpcode = opcode;
+    status = STATUS_UNHANDLED_OPCODE;
+}
+
+void ReferenceCore::skip()
+{
+    bool isLong = mode == MODE_XOCHIP && memory[pc & addressMask] == 0xF0 && memory[(pc + 1) & addressMask] == 0x00;
+
+    pc += isLong ? 4 : 2;
+}
+
+void ReferenceCore::setResolution(bool high)
+{
+    displayWidth = high ? Core::maxDisplayWidth : 64;
+    displayHeight = high ? Core::maxDisplayHeight : 32;
+
+    memset(display, 0, sizeof(display));
+}
+
+void ReferenceCore::scroll(int rows, int columns)
+{
+    unsigned char before [sizeof(display)];
+    memcpy(before, display, sizeof(display));
+
+    for (int y = 0; y < displayHeight; y++)
+    {
+        for (int x = 0; x < displayWidth; x++)
+        {
+            int fromX = x - columns;
+            int fromY = y - rows;
+            unsigned char moved = 0;
+
+            if (fromX >= 0 && fromX < displayWidth && fromY >= 0 && fromY < displayHeight)
+                moved = before[(fromY * displayWidth) + fromX] & planeMask;
+
+            disp(x, y) = (disp(x, y) & ~planeMask) | moved;
+        }
+    }
+}
+
+void ReferenceCore::hex0 (unsigned short opcode)
+{
+    if (mode != MODE_CHIP8)
+    {
+        unsigned short n = getHex(opcode, 3, 1);
+
+        if (getHex(opcode, 0, 3) == 0x00C)
+        {
+            //printf("Scroll down %d rows\n", n);
+            scroll(n, 0);
+            return;
+        }
+
+        if (getHex(opcode, 0, 3) == 0x00D && mode == MODE_XOCHIP)
+        {
+            //printf("Scroll up %d rows\n", n);
+            scroll(-n, 0);
+            return;
+        }
+
+        switch (opcode)
+        {
+            case 0x00FB:
+                //printf("Scroll right 4 pixels\n");
+                scroll(0, 4);
+                return;
+            case 0x00FC:
+                //printf("Scroll left 4 pixels\n");
+                scroll(0, -4);
+                return;
+            case 0x00FD:
+                //printf("Exit the interpreter\n");
+                pc -= 2;
+                status = STATUS_HALTED;
+                return;
+            case 0x00FE:
+                setResolution(false);
+                return;
+            case 0x00FF:
+                setResolution(true);
+                return;
+        }
+    }
+
+    switch (opcode)
+    {
+        case 0x00E0:
+            //printf("Clear the display\n");
+            for (int i = 0; i < displayWidth * displayHeight; i++)
+                display[i] &= ~planeMask;
+            break;
+        case 0x00EE:
+            //printf("Return from subroutine\n");
+            pc = stack[--sp & 0xF];
+            break;
+        default:
+            //0x0NNN
+            //printf("Execute machine subroutine %x\n", getHex(opcode, 1, 3));
+            break;
+    }
+}
+
+void ReferenceCore::goToAddress (unsigned short opcode)
+{
+    //first nibble = 1 or 2
+    //1 = jump, 2 = call
+    if (getHex(opcode, 0, 1) == 0x2)
+    {
+        //printf("Execute subroutine at %3x\n", getHex(opcode, 1, 3));
+        //Save program counter to stack
+        stack[sp & 0xF] = pc;
+        sp++;
+    }
+
+    pc = getHex(opcode, 1, 3);
+}
+
+void ReferenceCore::skipNextInstruction (unsigned short opcode)
+{
+    //3 = skip if equal to literal, 4 = skip if not equal to literal, 9 = skip if not equal to register
+    unsigned char x = getHex(opcode, 1, 1);
+
+    switch (getHex(opcode, 0, 1))
+    {
+        case 0x3:
+            if (registers[x] == getHex(opcode, 2, 2))
+                skip();
+            break;
+        case 0x4:
+            if (registers[x] != getHex(opcode, 2, 2))
+                skip();
+            break;
+        case 0x9:
+            if (registers[x] != registers[getHex(opcode, 2, 1)])
+                skip();
+            break;
+    }
+}
+
+void ReferenceCore::hex5 (unsigned short opcode)
+{
+    unsigned char x = getHex(opcode, 1, 1);
+    unsigned char y = getHex(opcode, 2, 1);
+
+    //XO-CHIP 5XY2 and 5XY3 store and load VX to VY, either way round, without moving I
+    if (mode == MODE_XOCHIP && (getHex(opcode, 3, 1) == 0x2 || getHex(opcode, 3, 1) == 0x3))
+    {
+        int step = x <= y ? 1 : -1;
+
+        for (int i = 0; i <= abs(y - x); i++)
+        {
+            if (getHex(opcode, 3, 1) == 0x2)
+                memory[(I + i) & addressMask] = registers[x + i * step];
+            else
+                registers[x + i * step] = memory[(I + i) & addressMask];
+        }
+
+        return;
+    }
+
+    //printf("Skip if %x is equal %x\n", x, y);
+    if (registers[x] == registers[y])
+        skip();
+}
+
+void ReferenceCore::hex6 (unsigned short opcode)
+{
+    //printf("Store %d in V%x\n", getHex(opcode, 2, 2), getHex(opcode, 1, 1));
+    registers[getHex(opcode, 1, 1)] = getHex(opcode, 2, 2);
+}
+
+void ReferenceCore::hex7 (unsigned short opcode)
+{
+    //printf("Add %d to  V%x\n", getHex(opcode, 2, 2), getHex(opcode, 1, 1));
+    registers[getHex(opcode, 1, 1)] += getHex(opcode, 2, 2);
+}
+
+void ReferenceCore::hex8 (unsigned short opcode)
+{
+    unsigned short x = getHex(opcode, 1, 1);
+    unsigned short y = getHex(opcode, 2, 1);
+    //The COSMAC VIP shifted VY into VX
+    unsigned short source = (quirks & QUIRK_SHIFT_VY) ? y : x;
+    bool resetVF = (quirks & QUIRK_VF_RESET) != 0;
+
+    switch (getHex(opcode, 3, 1))
+    {
+        case 0x0:
+            registers[x] = registers[y];
+            break;
+        case 0x1:
+            registers[x] |= registers[y];
+            if (resetVF)
+                registers[0xf] = 0;
+            break;
+        case 0x2:
+            registers[x] &= registers[y];
+            if (resetVF)
+                registers[0xf] = 0;
+            break;
+        case 0x3:
+            registers[x] ^= registers[y];
+            if (resetVF)
+                registers[0xf] = 0;
+            break;
+        case 0x4:
+        {
+            //VF first as it always has been, with X as F the result is what's left in it
+            unsigned short result = registers[x] + registers[y];
+            registers[0xf] = result > 255;
+            registers[x] = result;
+            break;
+        }
+        case 0x5:
+            registers[0xf] = registers[x] > registers[y];
+            registers[x] -= registers[y];
+            break;
+        case 0x6:
+            registers[0xf] = registers[source] & 0x1;
+            registers[x] = registers[source] >> 1;
+            break;
+        case 0x7:
+            registers[0xf] = registers[y] > registers[x];
+            registers[x] = registers[y] - registers[x];
+            break;
+        case 0xE:
+            registers[0xf] = (registers[source] & 0x80) > 0;
+            registers[x] = registers[source] << 1;
+            break;
+        default:
+            unhandled(opcode);
+            break;
+    }
+}
+
+void ReferenceCore::hexA (unsigned short opcode)
+{
+    //printf("Store %x in I\n", getHex(opcode, 1, 3));
+    I = getHex(opcode, 1, 3);
+}
+
+void ReferenceCore::hexB (unsigned short opcode)
+{
+    //printf("Jump to %x + v0\n", getHex(opcode, 1, 3));
+    //SUPER-CHIP's BXNN adds VX instead
+    pc = getHex(opcode, 1, 3) + registers[(quirks & QUIRK_JUMP_VX) ? getHex(opcode, 1, 1) : 0];
+}
+
+void ReferenceCore::hexC (unsigned short opcode)
+{
+    //printf("Set %x to a random number with mask %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 2));
+    registers[getHex(opcode, 1, 1)] = random() & getHex(opcode, 2, 2);
+}
+
+void ReferenceCore::hexD (unsigned short opcode)
+{
+    //printf("Draw sprite at x=%x y=%x with %x\n", getHex(opcode, 1, 1), getHex(opcode, 2, 1), getHex(opcode, 3, 1));
+    unsigned short x = registers[getHex(opcode, 1, 1)] % displayWidth;
+    unsigned short y = registers[getHex(opcode, 2, 1)] % displayHeight;
+    unsigned short height = getHex(opcode, 3, 1);
+    unsigned short width = 8;
+    bool clip = (quirks & QUIRK_CLIP) != 0;
+
+    //DXY0 is a 16x16 sprite outside plain CHIP-8, two bytes a row
+    if (height == 0 && mode != MODE_CHIP8)
+    {
+        width = 16;
+        height = 16;
+    }
+
+    unsigned short address = I;
+    int collidingRows = 0;
+
+    //One sprite after another for each selected plane
+    for (int plane = 0; plane < Core::maxPlanes; plane++)
+    {
+        unsigned char bit = 1 << plane;
+
+        if ((planeMask & bit) == 0)
+            continue;
+
+        for (int yline = 0; yline < height; yline++)
+        {
+            int row = y + yline;
+
+            if (row >= displayHeight)
+            {
+                if (clip)
+                    break;
+
+                row -= displayHeight;
+            }
+
+            unsigned short pixels = memory[(address + yline * (width / 8)) & addressMask] << 8;
+
+            if (width == 16)
+                pixels |= memory[(address + yline * 2 + 1) & addressMask];
+
+            bool collided = false;
+
+            for (int xline = 0; xline < width; xline++)
+            {
+                if ((pixels & (0x8000 >> xline)) == 0)
+                    continue;
+
+                int column = x + xline;
+
+                if (column >= displayWidth)
+                {
+                    if (clip)
+                        continue;
+
+                    column -= displayWidth;
+                }
+
+                //XOR-ed on, erasing a pixel is a collision
+                if (disp(column, row) & bit)
+                    collided = true;
+
+                disp(column, row) ^= bit;
+            }
+
+            if (collided)
+                collidingRows++;
+        }
+
+        address += height * width / 8;
+    }
+
+    //SUPER-CHIP in 128x64 counts the rows that collided, everything else just sets VF
+    if (mode == MODE_SCHIP && displayHeight == Core::maxDisplayHeight)
+        registers[0xF] = collidingRows;
+    else
+        registers[0xF] = collidingRows != 0;
+}
+
+void ReferenceCore::hexE (unsigned short opcode)
+{
+    //register[x] contains the Chip8 key to check, with no input nothing is ever pressed
+    unsigned char key = registers[getHex(opcode, 1, 1)] & 0xF;
+    bool keyState = input != nullptr && input->isKeyDown(key);
+
+    switch (getHex(opcode, 2, 2))
+    {
+        case 0x9E:
+            //printf("Skip if key stored in %x is pressed\n", getHex(opcode, 1, 1));
+            if (keyState)
+                skip();
+            break;
+        case 0xA1:
+            //printf("Skip if key stored in %x is NOT pressed \n", getHex(opcode, 1, 1));
+            if (!keyState)
+                skip();
+            break;
+        default:
+            unhandled(opcode);
+            break;
+    }
+}
+
+void ReferenceCore::hexF (unsigned short opcode)
+{
+    //Everything acts on the bit in position 1 (0x0f00)
+    unsigned short x = getHex(opcode, 1, 1);
+
+    if (mode == MODE_XOCHIP)
+    {
+        if (opcode == 0xF000)
+        {
+            //printf("Store the next 16 bits in I\n");
+            I = (memory[pc & addressMask] << 8) | memory[(pc + 1) & addressMask];
+            pc += 2;
+            return;
+        }
+
+        if (opcode == 0xF002)
+        {
+            //printf("Load the audio pattern from I\n");
+            for (int i = 0; i < 16; i++)
+                pattern[i] = memory[(I + i) & addressMask];
+            return;
+        }
+
+        switch (getHex(opcode, 2, 2))
+        {
+            case 0x01:
+                //printf("Select planes %x\n", x);
+                planeMask = x;
+                return;
+            case 0x3A:
+                //printf("Set the pitch to %x\n", x);
+                pitch = registers[x];
+                return;
+        }
+    }
+
+    if (mode != MODE_CHIP8)
+    {
+        //SUPER-CHIP only has 8 user flags
+        int last = mode == MODE_XOCHIP ? x : x % 8;
+
+        switch (getHex(opcode, 2, 2))
+        {
+            case 0x30:
+                //printf("Set I to address of big sprite data in %x\n", x);
+                I = bigFontStart + (registers[x] % 16) * 10;
+                return;
+            case 0x75:
+                for (int i = 0; i <= last; i++)
+                    flags[i] = registers[i];
+                return;
+            case 0x85:
+                for (int i = 0; i <= last; i++)
+                    registers[i] = flags[i];
+                return;
+        }
+    }
+
+    switch (getHex(opcode, 2, 2))
+    {
+        case 0x07:
+            //printf("Store value of delay timer in %x\n", x);
+            registers[x] = dt;
+            break;
+        case 0x0A:
+        {
+            //printf("Wait for a keypress and save in %x\n", x);
+            int key = input != nullptr ? input->getKeyPress() : -1;
+
+            if (key >= 0)
+            {
+                registers[x] = key & 0xF;
+                break;
+            }
+
+            //Back onto the Fx0A, emulateFrame finishes it when a key comes
+            waitingForKey = true;
+            keyRegister = x;
+            pc -= 2;
+            break;
+        }
+        case 0x15:
+            //printf("Set delay timer to value in %x\n", x);
+            dt = registers[x];
+            break;
+        case 0x18:
+            //printf("Set sound timer to value in %x\n", x);
+            st = registers[x];
+            break;
+        case 0x1E:
+            //printf("Add value in %x to register I\n", x);
+            //Set VF for overflow
+            registers[0xF] = (I + registers[x]) > addressMask;
+            I += registers[x];
+            break;
+        case 0x29:
+            //printf("Set I to address of sprite data in %x\n", x);
+            I = (registers[x] * 5);
+            break;
+        case 0x33:
+        {
+            //printf("Store binary coded decimal of %x in I, I+1, I+2\n", x);
+            int v = registers[x];
+
+            for (int i = 2; i >= 0; i--)
+            {
+                memory[(I + i) & addressMask] = v % 10;
+                v /= 10;
+            }
+
+            break;
+        }
+        case 0x55:
+            //printf("Store all registers v0 to v%x to memory starting at I\n", x);
+            for (int i = 0; i <= x; i++)
+            {
+                memory[(I + i) & addressMask] = registers[i];
+            }
+
+            if (quirks & QUIRK_MEMORY_INCREMENT)
+                I += x + 1;
+            break;
+        case 0x65:
+            //printf("Fill registers v0 to v%x from memory starting at I\n", x);
+            for (int i = 0; i <= x; i++)
+            {
+                registers[i] = memory[(I + i) & addressMask];
+            }
+
+            if (quirks & QUIRK_MEMORY_INCREMENT)
+                I += x + 1;
+            break;
+        default:
+            unhandled(opcode);
+            break;
+    }
+}
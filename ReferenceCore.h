@@ -0,0 +1,144 @@
+//
+//  ReferenceCore.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__ReferenceCore__
+#define __Chip8__ReferenceCore__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Core.h"
+#include "Decode.h"
+#include "Frontend.h"
+#include "Snapshot.h"
+
+//The interpreter as it was before the decode table, kept to check the Core's handlers against. Every opcode is
+//pulled apart with getHex and switched on by its first nibble, and the display is a byte per pixel. It shares no
+//code with the Core's handlers or drawing, only the Snapshot it's compared through and the font. It runs
+//frames the same way as a Core with idle skipping off: it never skips and never halts on a loop, only 00FD and
+//unhandled opcodes stop it. No Video, Timer or Audio, it's only there to be compared
+class ReferenceCore
+{
+public:
+    ReferenceCore();
+
+    void reset ();
+    //Same as Core's, resets and picks the mode's default quirks
+    void setMode (Mode newMode);
+    Mode getMode () const { return mode; }
+    void setQuirks (uint8_t newQuirks) { quirks = newQuirks & (quirkCombinations - 1); }
+    uint8_t getQuirks () const { return quirks; }
+    bool loadROM (const unsigned char* data, size_t size);
+    uint64_t getROMHash () const { return romHash; }
+
+    //Written and read in the Core's layout, so the two can be compared byte for byte and handed each other's state
+    void saveState (Snapshot& snapshot) const;
+    bool loadState (const Snapshot& snapshot);
+
+    void setInput (Input* newInput) { input = newInput; }
+    void setInstructionRate (int rate) { instructionRate = rate; }
+    void setTimerRate (int rate) { timerRate = rate; }
+    void seed (uint32_t value);
+
+    //One timer tick worth of instructions then the tick itself
+    void emulateFrame ();
+    //count instructions, fewer if Fx0A stops to wait
+    void emulateCycles (int count);
+
+    uint64_t getCycles () const { return cycles; }
+    Status getStatus () const { return status; }
+    bool isWaitingForKey () const { return waitingForKey; }
+    const unsigned char* getMemory () const { return memory; }
+    size_t getMemorySize () const { return memorySize; }
+    const unsigned char* getRegisters () const { return registers; }
+    unsigned short getI () const { return I; }
+    unsigned short getPC () const { return pc; }
+    unsigned char getDelayTimer () const { return dt; }
+    unsigned char getSoundTimer () const { return st; }
+    //Packed the way Core::hashDisplay hashes it, so the two give the same value for the same picture
+    uint64_t hashDisplay () const;
+
+private:
+    //Returns the value at position (0 - 3, from the left) in opcode, length nibbles long
+    static unsigned short getHex (unsigned short opcode, uint8_t position, uint8_t length);
+
+    void emulateCycle ();
+
+    void hex0 (unsigned short opcode);
+    void goToAddress (unsigned short opcode);
+    void skipNextInstruction (unsigned short opcode);
+    void hex5 (unsigned short opcode);
+    void hex6 (unsigned short opcode);
+    void hex7 (unsigned short opcode);
+    void hex8 (unsigned short opcode);
+    void hexA (unsigned short opcode);
+    void hexB (unsigned short opcode);
+    void hexC (unsigned short opcode);
+    void hexD (unsigned short opcode);
+    void hexE (unsigned short opcode);
+    void hexF (unsigned short opcode);
+    //Leaves pc on it and stops
+    void unhandled (unsigned short opcode);
+
+    //Moves pc past the next instruction, 4 bytes for an XO-CHIP F000
+    void skip ();
+    //Every selected plane moved by rows down and columns right, what comes in at the edges is blank
+    void scroll (int rows, int columns);
+    //Switches between 64x32 and 128x64 and clears every plane
+    void setResolution (bool high);
+    //Core's packed layout, a bit per pixel and a plane after another
+    void packDisplay (uint64_t* words) const;
+    int getDisplayPlanes () const { return mode == MODE_XOCHIP ? Core::maxPlanes : 1; }
+
+    unsigned char& disp (int x, int y) { return display[(y * displayWidth) + x]; }
+    unsigned char random ();
+
+    ////////////////////////
+    //      Variables     //
+    ////////////////////////
+    Input* input;
+
+    uint64_t romHash;
+    Status status;
+    unsigned short unhandledOpcode;
+    bool waitingForKey;
+    unsigned char keyRegister;
+
+    Mode mode;
+    uint8_t quirks;
+
+    unsigned char memory [0x10000];
+    size_t memorySize;
+    unsigned short addressMask;
+
+    unsigned char registers [16];
+    unsigned short I;
+    unsigned short pc;
+    unsigned char sp;
+    unsigned short stack [16];
+    unsigned char st;
+    unsigned char dt;
+
+    int displayWidth;
+    int displayHeight;
+    //A byte per pixel, displayWidth to a row. Bit p is the pixel in plane p
+    unsigned char display [Core::maxDisplayWidth * Core::maxDisplayHeight];
+    unsigned char planeMask;
+
+    unsigned char flags [16];
+    unsigned char pattern [16];
+    unsigned char pitch;
+
+    int instructionRate;
+    int timerRate;
+    long instructionCredit;
+    uint64_t cycles;
+    uint32_t randomState;
+};
+
+#endif /* defined(__Chip8__ReferenceCore__) */
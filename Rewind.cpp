@@ -0,0 +1,122 @@
+//
+//  Rewind.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Rewind.h"
+
+#include <chrono>
+
+using namespace std;
+
+Rewind::Rewind(size_t budget)
+{
+    ring.resize(budget);
+    latest = unique_ptr<Snapshot>(new Snapshot);
+    current = unique_ptr<Snapshot>(new Snapshot);
+    hasLatest = false;
+    recordSeconds = 0;
+    recordCount = 0;
+
+    clear();
+}
+
+void Rewind::clear()
+{
+    entries.clear();
+    head = 0;
+    bytesUsed = 0;
+    hasLatest = false;
+}
+
+void Rewind::record(const Core& core)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    core.saveState(*current);
+
+    if (hasLatest)
+    {
+        //Backwards delta - applied to current it gives back latest
+        encodeDelta(*current, *latest, scratch);
+
+        //Just the base hash means nothing changed (first frame after a stepBack, or the machine is stopped), so
+        //there's nothing to go back to
+        bool changed = scratch.size() > sizeof(uint64_t);
+
+        if (changed && scratch.size() > ring.size())
+        {
+            //Can't keep this frame, and without it nothing older can be reached either
+            entries.clear();
+            head = 0;
+            bytesUsed = 0;
+        }
+        else if (changed)
+        {
+            size_t offset = allocate(scratch.size());
+            memcpy(&ring[offset], scratch.data(), scratch.size());
+
+            entries.push_back({offset, scratch.size()});
+            bytesUsed += scratch.size();
+        }
+    }
+
+    swap(latest, current);
+    hasLatest = true;
+
+    recordSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    recordCount++;
+}
+
+size_t Rewind::allocate(size_t length)
+{
+    //Frames are written in order around the ring, so the oldest ones are always the next ones after head
+    if (head + length > ring.size())
+    {
+        //Not enough before the end, what's left there is the oldest history - drop it and start again at 0
+        while (!entries.empty() && entries.front().offset >= head)
+        {
+            bytesUsed -= entries.front().length;
+            entries.pop_front();
+        }
+
+        head = 0;
+    }
+
+    while (!entries.empty() && entries.front().offset >= head && entries.front().offset < head + length)
+    {
+        bytesUsed -= entries.front().length;
+        entries.pop_front();
+    }
+
+    size_t offset = head;
+    head += length;
+
+    return offset;
+}
+
+bool Rewind::stepBack(Core& core)
+{
+    if (entries.empty())
+        return false;
+
+    Entry entry = entries.back();
+    entries.pop_back();
+    bytesUsed -= entry.length;
+    //The space it used is the newest in the ring, hand it back
+    head = entry.offset;
+
+    if (!applyDelta(*latest, &ring[entry.offset], entry.length, *latest))
+    {
+        //Only happens if the Core changed under us without being recorded, nothing older is any use now
+        clear();
+        return false;
+    }
+
+    core.loadState(*latest);
+
+    return true;
+}
@@ -0,0 +1,71 @@
+//
+//  Rewind.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Rewind__
+#define __Chip8__Rewind__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "Core.h"
+#include "Snapshot.h"
+
+//Frame history for stepping a Core backwards. Only the newest state is kept whole, every frame before it is
+//a delta that turns the state after it back into it, so going back a frame is one applyDelta and the oldest
+//frames can be dropped without touching anything else. The deltas live in one ring of budget bytes, nothing
+//is allocated per frame
+class Rewind
+{
+public:
+    Rewind (size_t budget);
+
+    //Call once per frame, before the frame runs
+    void record (const Core& core);
+    //Puts the Core back one recorded frame, false when there's no history left
+    bool stepBack (Core& core);
+    //Forget everything, for a new ROM
+    void clear ();
+
+    //Frames that can be stepped back
+    size_t getFrames () const { return entries.size(); }
+    size_t getBytesUsed () const { return bytesUsed; }
+    size_t getBudget () const { return ring.size(); }
+    //Mean time spent in record, in microseconds
+    double getAverageRecordTime () const { return recordCount > 0 ? recordSeconds / recordCount * 1e6 : 0; }
+
+private:
+    struct Entry
+    {
+        size_t offset;
+        size_t length;
+    };
+
+    //Makes room for length bytes at the head, dropping the oldest frames, and returns where they go
+    size_t allocate (size_t length);
+
+    std::vector<uint8_t> ring;
+    size_t head;
+    size_t bytesUsed;
+    //Oldest first
+    std::deque<Entry> entries;
+
+    //Newest recorded state, and whether there is one. Swapped with current rather than copied, they're 72K
+    std::unique_ptr<Snapshot> latest;
+    bool hasLatest;
+
+    std::unique_ptr<Snapshot> current;
+    std::vector<uint8_t> scratch;
+
+    double recordSeconds;
+    long recordCount;
+};
+
+#endif /* defined(__Chip8__Rewind__) */
@@ -0,0 +1,346 @@
+//
+//  Rom.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Rom.h"
+#include "Decode.h"
+#include "Quirks.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+//hash size modified mode quirks ips status frames cycles display path, then the title takes the rest of the line
+static const int indexFields = 11;
+
+MappedROM::MappedROM(const char* location, size_t maxSize)
+{
+    data = nullptr;
+    size = 0;
+    modified = 0;
+
+    int file = open(location, O_RDONLY);
+
+    if (file < 0)
+    {
+        cerr << "Error opening file " << location << endl;
+        return;
+    }
+
+    struct stat info;
+
+    if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode))
+        cerr << "Error opening file " << location << endl;
+    else if (info.st_size == 0)
+        cerr << "Empty ROM " << location << endl;
+    else if ((size_t) info.st_size > maxSize)
+        cerr << "ROM too large " << info.st_size << " bytes, " << maxSize << " fit" << endl;
+    else
+    {
+        void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+        if (mapping != MAP_FAILED)
+        {
+            data = (const unsigned char*) mapping;
+            size = info.st_size;
+            modified = info.st_mtime;
+        }
+        else
+            cerr << "Error mapping " << location << endl;
+    }
+
+    //The mapping keeps the file alive
+    close(file);
+}
+
+MappedROM::~MappedROM()
+{
+    if (data != nullptr)
+        munmap((void*) data, size);
+}
+
+void addROMPath(const string& path, vector<string>& roms)
+{
+    struct stat info;
+
+    if (stat(path.c_str(), &info) != 0)
+    {
+        cerr << "Can't find " << path << endl;
+        return;
+    }
+
+    if (!S_ISDIR(info.st_mode))
+    {
+        roms.push_back(path);
+        return;
+    }
+
+    DIR* directory = opendir(path.c_str());
+
+    if (directory == nullptr)
+        return;
+
+    vector<string> entries;
+
+    while (dirent* entry = readdir(directory))
+    {
+        string name = entry->d_name;
+
+        if (name != "." && name != "..")
+            entries.push_back(path + "/" + name);
+    }
+
+    closedir(directory);
+
+    //readdir order is whatever the filesystem likes, keep the output stable between runs
+    sort(entries.begin(), entries.end());
+
+    for (const string& entry : entries)
+        addROMPath(entry, roms);
+}
+
+bool addROMList(const string& location, vector<string>& roms)
+{
+    ifstream list(location);
+    string line;
+
+    if (!list.is_open())
+        return false;
+
+    while (getline(list, line))
+    {
+        if (!line.empty())
+            addROMPath(line, roms);
+    }
+
+    return true;
+}
+
+static string titleFromPath(const string& location)
+{
+    size_t slash = location.find_last_of('/');
+    string name = slash == string::npos ? location : location.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+
+    return dot == string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+//Paths and titles can have anything in them, tabs and line breaks would split the line. Backslash escaped like C
+static string escapeField(const string& field)
+{
+    string escaped;
+
+    for (char c : field)
+    {
+        switch (c)
+        {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default: escaped += c; break;
+        }
+    }
+
+    return escaped;
+}
+
+static string unescapeField(const string& field)
+{
+    string unescaped;
+
+    for (size_t i = 0; i < field.size(); i++)
+    {
+        if (field[i] != '\\' || i + 1 == field.size())
+        {
+            unescaped += field[i];
+            continue;
+        }
+
+        switch (field[++i])
+        {
+            case 't': unescaped += '\t'; break;
+            case 'n': unescaped += '\n'; break;
+            case 'r': unescaped += '\r'; break;
+            case '\\': unescaped += '\\'; break;
+            //Not one of ours, leave it as it was typed
+            default: unescaped += '\\'; unescaped += field[i]; break;
+        }
+    }
+
+    return unescaped;
+}
+
+bool RomIndex::load(const char* location)
+{
+    ifstream file(location);
+
+    if (!file.is_open())
+    {
+        struct stat info;
+        return stat(location, &info) != 0;
+    }
+
+    string line;
+    int number = 0;
+
+    while (getline(file, line))
+    {
+        number++;
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        vector<string> fields;
+        stringstream stream(line);
+        string field;
+
+        while ((int) fields.size() < indexFields - 1 && getline(stream, field, '\t'))
+            fields.push_back(field);
+
+        //A title edited by hand might have a real tab in, whatever's left is the title
+        getline(stream, field);
+        fields.push_back(field);
+
+        RomEntry entry;
+        uint64_t hash;
+        Mode mode;
+
+        if (fields.size() != indexFields)
+        {
+            fprintf(stderr, "%s:%d: expected %d tab separated fields\n", location, number, indexFields);
+            return false;
+        }
+
+        if (!parseROMHash(fields[0], hash))
+        {
+            fprintf(stderr, "%s:%d: bad rom hash %s\n", location, number, fields[0].c_str());
+            return false;
+        }
+
+        if (fields[3] != "-")
+        {
+            if (!parseMode(fields[3].c_str(), mode))
+            {
+                fprintf(stderr, "%s:%d: unknown mode %s\n", location, number, fields[3].c_str());
+                return false;
+            }
+
+            entry.mode = mode;
+        }
+
+        entry.size = strtoull(fields[1].c_str(), nullptr, 10);
+        entry.modified = strtoll(fields[2].c_str(), nullptr, 10);
+        entry.instructionRate = atoi(fields[4].c_str());
+        entry.status = fields[5] == "-" ? "" : fields[5];
+        entry.frames = atol(fields[6].c_str());
+        entry.cycles = strtoull(fields[7].c_str(), nullptr, 10);
+        entry.displayHash = strtoull(fields[8].c_str(), nullptr, 16);
+        entry.path = unescapeField(fields[9]);
+        entry.title = unescapeField(fields[10]);
+
+        paths[entry.path] = hash;
+        entries[hash] = entry;
+    }
+
+    return true;
+}
+
+bool RomIndex::save(const char* location) const
+{
+    string temporary = string(location) + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "w");
+
+    if (file == nullptr)
+        return false;
+
+    //Sorted so the file diffs cleanly
+    vector<const pair<const uint64_t, RomEntry>*> sorted;
+
+    for (const pair<const uint64_t, RomEntry>& entry : entries)
+        sorted.push_back(&entry);
+
+    sort(sorted.begin(), sorted.end(), [] (const pair<const uint64_t, RomEntry>* a, const pair<const uint64_t, RomEntry>* b) { return a->first < b->first; });
+
+    fprintf(file, "#rom hash\tsize\tmodified\tmode\tips\tstatus\tframes\tcycles\tdisplay\tpath\ttitle\n");
+
+    for (const pair<const uint64_t, RomEntry>* item : sorted)
+    {
+        const RomEntry& entry = item->second;
+
+        fprintf(file, "%016llx\t%llu\t%lld\t%s\t%d\t%s\t%ld\t%llu\t%016llx\t%s\t%s\n",
+                (unsigned long long) item->first, (unsigned long long) entry.size, (long long) entry.modified,
+                entry.mode >= 0 ? getModeName((Mode) entry.mode) : "-", entry.instructionRate, entry.status.empty() ? "-" : entry.status.c_str(), entry.frames,
+                (unsigned long long) entry.cycles, (unsigned long long) entry.displayHash,
+                escapeField(entry.path).c_str(), escapeField(entry.title).c_str());
+    }
+
+    bool written = fclose(file) == 0;
+
+    if (!written || rename(temporary.c_str(), location) != 0)
+    {
+        remove(temporary.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+const RomEntry* RomIndex::find(uint64_t romHash) const
+{
+    auto found = entries.find(romHash);
+
+    return found == entries.end() ? nullptr : &found->second;
+}
+
+bool RomIndex::findPath(const string& location, uint64_t& romHash) const
+{
+    auto found = paths.find(location);
+
+    if (found == paths.end())
+        return false;
+
+    //Moved on since, or something else has been indexed at this path
+    const RomEntry* entry = find(found->second);
+    struct stat info;
+
+    if (entry == nullptr || entry->path != location || stat(location.c_str(), &info) != 0)
+        return false;
+
+    if ((uint64_t) info.st_size != entry->size || (int64_t) info.st_mtime != entry->modified)
+        return false;
+
+    romHash = found->second;
+    return true;
+}
+
+RomEntry& RomIndex::add(uint64_t romHash, const string& location, uint64_t size, int64_t modified)
+{
+    RomEntry& entry = entries[romHash];
+
+    if (entry.title.empty())
+        entry.title = titleFromPath(location);
+
+    entry.path = location;
+    entry.size = size;
+    entry.modified = modified;
+    paths[location] = romHash;
+
+    return entry;
+}
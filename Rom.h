@@ -0,0 +1,97 @@
+//
+//  Rom.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Rom__
+#define __Chip8__Rom__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Read only mapping of a ROM file, the only way ROMs come off disk
+class MappedROM
+{
+public:
+    //Empty files and anything over maxSize bytes are refused, with the reason on stderr
+    MappedROM (const char* location, size_t maxSize);
+    ~MappedROM();
+
+    //nullptr if the file couldn't be opened, mapped or is the wrong size
+    const unsigned char* getData () const { return data; }
+    size_t getSize () const { return size; }
+    //Modification time in seconds, what RomIndex checks to know a file hasn't changed
+    int64_t getModified () const { return modified; }
+
+private:
+    MappedROM (const MappedROM&) = delete;
+    MappedROM& operator= (const MappedROM&) = delete;
+
+    const unsigned char* data;
+    size_t size;
+    int64_t modified;
+};
+
+//A corpus to run - a ROM file, or every file under a directory in name order. Anything that isn't there is
+//reported on stderr and skipped
+void addROMPath (const std::string& path, std::vector<std::string>& roms);
+//addROMPath for each line of a list file, false if it can't be read
+bool addROMList (const std::string& location, std::vector<std::string>& roms);
+
+//Everything known about one ROM
+struct RomEntry
+{
+    //The file name without its extension until someone edits it
+    std::string title;
+    //Where it was last seen and what the file looked like then, so it can be found again without reading it
+    std::string path;
+    uint64_t size;
+    int64_t modified;
+
+    //-1 when whoever runs it should decide. Quirks aren't here, a QuirkDatabase is the one place they're kept
+    int mode;
+    //Instructions per second, 0 for the usual speed
+    int instructionRate;
+
+    //Last batch run, status is empty if it's never been run
+    std::string status;
+    long frames;
+    uint64_t cycles;
+    uint64_t displayHash;
+
+    RomEntry () : size(0), modified(0), mode(-1), instructionRate(0), frames(0), cycles(0), displayHash(0) {}
+};
+
+//ROMs by hashROM of their contents, kept as a tab separated text file with one ROM per line - hand editable, and
+//small enough to load whole for a corpus of thousands. Tabs, line breaks and backslashes in paths and titles are
+//written as \t, \n, \r and \\ the way C does
+class RomIndex
+{
+public:
+    //A file that isn't there yet is an empty index, false only if it can't be read or is damaged
+    bool load (const char* location);
+    //Written next to location and renamed over it, so a run that dies half way doesn't lose the index
+    bool save (const char* location) const;
+
+    //nullptr if the ROM isn't in it
+    const RomEntry* find (uint64_t romHash) const;
+    //The hash of the file at location if it's indexed there and its size and modification time haven't changed,
+    //only stats the file
+    bool findPath (const std::string& location, uint64_t& romHash) const;
+    //The entry for romHash, made with a title from the file name if it's new. Either way location is where it
+    //lives now
+    RomEntry& add (uint64_t romHash, const std::string& location, uint64_t size, int64_t modified);
+    size_t size () const { return entries.size(); }
+
+private:
+    std::unordered_map<uint64_t, RomEntry> entries;
+    std::unordered_map<std::string, uint64_t> paths;
+};
+
+#endif /* defined(__Chip8__Rom__) */
@@ -0,0 +1,84 @@
+//
+//  SampleRing.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__SampleRing__
+#define __Chip8__SampleRing__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+//Samples from the emulation thread to the audio callback. One thread only ever pushes and the other only ever
+//pops, so head and tail each have a single writer and nothing needs a lock. The buffer is sized once up front,
+//neither side allocates
+class SampleRing
+{
+public:
+    //Capacity is rounded up to a power of two
+    SampleRing (size_t capacity)
+    {
+        size_t size = 1;
+
+        while (size < capacity)
+            size <<= 1;
+
+        buffer.resize(size);
+        mask = size - 1;
+        head = 0;
+        tail = 0;
+    }
+
+    //Producer side, returns how many fitted
+    size_t push (const int16_t* samples, size_t count)
+    {
+        size_t write = head.load(std::memory_order_relaxed);
+        size_t space = buffer.size() - (write - tail.load(std::memory_order_acquire));
+
+        if (count > space)
+            count = space;
+
+        for (size_t i = 0; i < count; i++)
+            buffer[(write + i) & mask] = samples[i];
+
+        head.store(write + count, std::memory_order_release);
+
+        return count;
+    }
+
+    //Consumer side, returns how many there were
+    size_t pop (int16_t* samples, size_t count)
+    {
+        size_t read = tail.load(std::memory_order_relaxed);
+        size_t available = head.load(std::memory_order_acquire) - read;
+
+        if (count > available)
+            count = available;
+
+        for (size_t i = 0; i < count; i++)
+            samples[i] = buffer[(read + i) & mask];
+
+        tail.store(read + count, std::memory_order_release);
+
+        return count;
+    }
+
+    //Only exact from one of the two threads, a guide from anywhere else
+    size_t size () const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    size_t capacity () const { return buffer.size(); }
+
+private:
+    std::vector<int16_t> buffer;
+    size_t mask;
+
+    //Both only ever count up, the index is taken with mask. Kept apart so the two threads don't share a cache line
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif /* defined(__Chip8__SampleRing__) */
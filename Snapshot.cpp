@@ -0,0 +1,243 @@
+//
+//  Snapshot.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "Snapshot.h"
+#include "Hash.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+
+//Zero bytes in a row before a literal run is worth ending
+static const size_t minimumZeroRun = 4;
+
+bool Snapshot::isValid() const
+{
+    return magic == magicValue && version == currentVersion && size == sizeof(Snapshot) &&
+           memorySize <= sizeof(memory) && memorySize % sizeof(uint64_t) == 0 &&
+           displaySize <= sizeof(display) && displaySize % sizeof(uint64_t) == 0;
+}
+
+//The parts of a pair of snapshots either of them uses, in order - the state and display, then memory. Either
+//side can be bigger, the mode or resolution might have changed between them
+static void getUsedRanges(const Snapshot& a, const Snapshot& b, size_t ranges [2][2])
+{
+    ranges[0][0] = 0;
+    ranges[0][1] = max(a.getStateSize(), b.getStateSize());
+    ranges[1][0] = offsetof(Snapshot, memory);
+    ranges[1][1] = offsetof(Snapshot, memory) + max(a.memorySize, b.memorySize);
+}
+
+bool writeSnapshot(const char* location, const Snapshot& snapshot)
+{
+    FILE* file = fopen(location, "wb");
+
+    if (file == nullptr)
+        return false;
+
+    bool written = fwrite(&snapshot, sizeof(snapshot), 1, file) == 1;
+
+    return fclose(file) == 0 && written;
+}
+
+bool readSnapshot(const char* location, Snapshot& snapshot)
+{
+    FILE* file = fopen(location, "rb");
+
+    if (file == nullptr)
+        return false;
+
+    bool read = fread(&snapshot, sizeof(snapshot), 1, file) == 1;
+    fclose(file);
+
+    return read && snapshot.isValid();
+}
+
+MappedSnapshot::MappedSnapshot(const char* location)
+{
+    snapshot = nullptr;
+    mappedSize = 0;
+
+    int file = open(location, O_RDONLY);
+
+    if (file < 0)
+        return;
+
+    struct stat info;
+
+    if (fstat(file, &info) == 0 && (size_t) info.st_size >= sizeof(Snapshot))
+    {
+        void* mapping = mmap(nullptr, sizeof(Snapshot), PROT_READ, MAP_PRIVATE, file, 0);
+
+        if (mapping != MAP_FAILED)
+        {
+            mappedSize = sizeof(Snapshot);
+            snapshot = (const Snapshot*) mapping;
+        }
+    }
+
+    //The mapping keeps the file alive
+    close(file);
+
+    if (snapshot != nullptr && !snapshot->isValid())
+    {
+        munmap((void*) snapshot, mappedSize);
+        snapshot = nullptr;
+    }
+}
+
+MappedSnapshot::~MappedSnapshot()
+{
+    if (snapshot != nullptr)
+        munmap((void*) snapshot, mappedSize);
+}
+
+//Only has to tell bases apart, and only the parts in use can differ
+static uint64_t hashSnapshot(const Snapshot& snapshot)
+{
+    uint64_t hash = fnv1a(&snapshot, snapshot.getStateSize());
+    return fnv1a(snapshot.memory, snapshot.memorySize, hash);
+}
+
+static void writeVarint(vector<uint8_t>& out, size_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((uint8_t) (value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back((uint8_t) value);
+}
+
+static bool readVarint(const uint8_t* data, size_t size, size_t& position, size_t& value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (position >= size)
+            return false;
+
+        uint8_t byte = data[position++];
+        value |= (size_t) (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+void encodeDelta(const Snapshot& base, const Snapshot& next, vector<uint8_t>& delta)
+{
+    const uint8_t* a = (const uint8_t*) &base;
+    const uint8_t* b = (const uint8_t*) &next;
+    size_t ranges [2][2];
+
+    getUsedRanges(base, next, ranges);
+
+    uint64_t hash = hashSnapshot(base);
+    delta.resize(sizeof(hash));
+    memcpy(delta.data(), &hash, sizeof(hash));
+
+    //[zero run][literal length][literal bytes] until the end, the bytes are next ^ base. Nothing outside the
+    //ranges can differ, a zero run goes straight over the gap between them
+    size_t start = 0;
+
+    for (int range = 0; range < 2; range++)
+    {
+        size_t position = ranges[range][0];
+        const size_t total = ranges[range][1];
+
+        while (position < total)
+        {
+            //Most of it is unchanged, skip a word at a time while we can
+            while (position + 8 <= total && memcmp(&a[position], &b[position], 8) == 0)
+                position += 8;
+
+            while (position < total && a[position] == b[position])
+                position++;
+
+            if (position == total)
+                break;
+
+            size_t zeroRun = position - start;
+            size_t literalStart = position;
+            size_t zeros = 0;
+
+            //Literal carries on through short gaps, a zero run costs at least two bytes of header
+            while (position < total && zeros < minimumZeroRun)
+            {
+                zeros = a[position] == b[position] ? zeros + 1 : 0;
+                position++;
+            }
+
+            size_t literalEnd = position - zeros;
+            position = literalEnd;
+            start = literalEnd;
+
+            writeVarint(delta, zeroRun);
+            writeVarint(delta, literalEnd - literalStart);
+
+            for (size_t i = literalStart; i < literalEnd; i++)
+                delta.push_back(a[i] ^ b[i]);
+        }
+    }
+}
+
+bool applyDelta(const Snapshot& base, const uint8_t* delta, size_t size, Snapshot& out)
+{
+    uint64_t hash;
+
+    if (size < sizeof(hash))
+        return false;
+
+    memcpy(&hash, delta, sizeof(hash));
+
+    //The sizes in base say how much of it to hash
+    if (!base.isValid() || hash != hashSnapshot(base))
+        return false;
+
+    if (&out != &base)
+        out = base;
+
+    uint8_t* bytes = (uint8_t*) &out;
+    size_t position = 0;
+    size_t read = sizeof(hash);
+
+    while (read < size)
+    {
+        size_t zeroRun;
+        size_t length;
+
+        if (!readVarint(delta, size, read, zeroRun) || !readVarint(delta, size, read, length))
+            return false;
+
+        position += zeroRun;
+
+        if (position + length > sizeof(Snapshot) || read + length > size)
+            return false;
+
+        for (size_t i = 0; i < length; i++)
+            bytes[position + i] ^= delta[read + i];
+
+        position += length;
+        read += length;
+    }
+
+    return out.isValid();
+}
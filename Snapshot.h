@@ -0,0 +1,100 @@
+//
+//  Snapshot.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__Snapshot__
+#define __Chip8__Snapshot__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+//Everything needed to carry on a Core from where it was. Fixed layout with no pointers so it can go to disk
+//and come back (or be mmapped) as is - host byte order, it's for forking runs on the same machine, not for
+//swapping between them. Settings (rates, dispatch, frontends) aren't machine state and stay with the Core
+struct Snapshot
+{
+    static const uint32_t magicValue = 0x53533843;     //"C8SS"
+    static const uint32_t currentVersion = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    //sizeof(Snapshot) when written, catches a blob from a build with a different layout
+    uint32_t size;
+    uint32_t randomState;
+    //Bytes of memory and display the machine was using, from the start of each. Everything past them is zero,
+    //deltas and their hashes don't look there
+    uint32_t memorySize;
+    uint32_t displaySize;
+
+    uint8_t registers [16];
+    uint16_t stack [16];
+    uint16_t I;
+    uint16_t pc;
+    uint8_t sp;
+    uint8_t dt;
+    uint8_t st;
+    uint8_t status;
+    uint16_t unhandledOpcode;
+    uint8_t waitingForKey;
+    uint8_t keyRegister;
+    uint8_t mode;
+    uint8_t hires;
+    uint8_t planeMask;
+    uint8_t pitch;
+    //Quirk bits the handlers were picked for
+    uint8_t quirks;
+    uint8_t flags [16];
+    uint8_t pattern [16];
+
+    uint64_t cycles;
+    int64_t instructionCredit;
+
+    //Every plane at the largest resolution. Last with memory so the parts in use are two runs of bytes
+    uint64_t display [4 * 64 * 2];
+    //All 64K for XO-CHIP, only the first 4K is used otherwise
+    uint8_t memory [0x10000];
+
+    //Right magic, version and size, and memorySize and displaySize fit
+    bool isValid () const;
+    //Bytes from the start up to the end of the display in use - everything but memory
+    size_t getStateSize () const { return offsetof(Snapshot, display) + displaySize; }
+};
+
+static_assert(std::is_trivially_copyable<Snapshot>::value, "Snapshot has to be a plain blob");
+
+//Whole snapshot to and from a file
+bool writeSnapshot (const char* location, const Snapshot& snapshot);
+bool readSnapshot (const char* location, Snapshot& snapshot);
+
+//Read only mapping of a snapshot file, for restoring without a copy through a buffer first
+class MappedSnapshot
+{
+public:
+    MappedSnapshot (const char* location);
+    ~MappedSnapshot();
+
+    //nullptr if the file couldn't be mapped or isn't a valid snapshot
+    const Snapshot* get () const { return snapshot; }
+
+private:
+    MappedSnapshot (const MappedSnapshot&) = delete;
+    MappedSnapshot& operator= (const MappedSnapshot&) = delete;
+
+    const Snapshot* snapshot;
+    size_t mappedSize;
+};
+
+//A delta is next XORed against base and run length encoded - frame to frame almost all of it is zero. It
+//carries a hash of base so it can't be applied to the wrong one
+void encodeDelta (const Snapshot& base, const Snapshot& next, std::vector<uint8_t>& delta);
+//out = base + delta, false if the delta doesn't belong to base or is damaged (out is garbage then). out may
+//be base
+bool applyDelta (const Snapshot& base, const uint8_t* delta, size_t size, Snapshot& out);
+
+#endif /* defined(__Chip8__Snapshot__) */
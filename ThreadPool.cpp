@@ -0,0 +1,88 @@
+//
+//  ThreadPool.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include "ThreadPool.h"
+
+#include <thread>
+
+using namespace std;
+
+ThreadPool::ThreadPool (int threads)
+{
+    threadCount = threads > 0 ? threads : (int) thread::hardware_concurrency();
+
+    if (threadCount < 1)
+        threadCount = 1;
+
+    for (int i = 0; i < threadCount; i++)
+        queues.push_back(unique_ptr<Queue>(new Queue()));
+}
+
+void ThreadPool::run (size_t count, const function<void (size_t)>& job)
+{
+    //Contiguous shares, so neighbouring jobs (usually ROMs from the same directory) stay on one worker
+    for (int worker = 0; worker < threadCount; worker++)
+    {
+        size_t first = count * worker / threadCount;
+        size_t last = count * (worker + 1) / threadCount;
+
+        for (size_t i = first; i < last; i++)
+            queues[worker]->jobs.push_back(i);
+    }
+
+    vector<thread> threads;
+
+    //The calling thread is worker 0
+    for (int worker = 1; worker < threadCount; worker++)
+        threads.push_back(thread(&ThreadPool::work, this, worker, cref(job)));
+
+    work(0, job);
+
+    for (thread& t : threads)
+        t.join();
+}
+
+bool ThreadPool::popOwn (int worker, size_t& job)
+{
+    Queue& queue = *queues[worker];
+    lock_guard<mutex> guard(queue.lock);
+
+    if (queue.jobs.empty())
+        return false;
+
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal (int worker, size_t& job)
+{
+    for (int offset = 1; offset < threadCount; offset++)
+    {
+        Queue& victim = *queues[(worker + offset) % threadCount];
+        lock_guard<mutex> guard(victim.lock);
+
+        if (!victim.jobs.empty())
+        {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::work (int worker, const function<void (size_t)>& job)
+{
+    size_t next;
+
+    //Nothing is ever added once run has started, so when there's nothing to steal everything is taken
+    while (popOwn(worker, next) || steal(worker, next))
+        job(next);
+}
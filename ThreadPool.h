@@ -0,0 +1,47 @@
+//
+//  ThreadPool.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__ThreadPool__
+#define __Chip8__ThreadPool__
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Work stealing pool for lots of independent jobs of very different lengths (one ROM might stop after a frame,
+//the next runs for a million). Every worker starts with its own share of the jobs and takes from the back of
+//its own queue, once that's empty it steals from the front of someone else's
+class ThreadPool
+{
+public:
+    //0 threads = one per core
+    ThreadPool (int threads = 0);
+
+    int getThreadCount () const { return threadCount; }
+
+    //Calls job(i) for every i in [0, count) and returns once they've all finished
+    void run (size_t count, const std::function<void (size_t)>& job);
+
+private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<size_t> jobs;
+    };
+
+    bool popOwn (int worker, size_t& job);
+    bool steal (int worker, size_t& job);
+    void work (int worker, const std::function<void (size_t)>& job);
+
+    int threadCount;
+    std::vector<std::unique_ptr<Queue>> queues;
+};
+
+#endif /* defined(__Chip8__ThreadPool__) */
@@ -0,0 +1,76 @@
+//
+//  TripleBuffer.h
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#ifndef __Chip8__TripleBuffer__
+#define __Chip8__TripleBuffer__
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+//Finished framebuffers from the emulation thread to the one presenting them. Three copies - one being written, one
+//being shown, and the newest finished one in between - so neither side ever waits for the other. If frames come
+//faster than they're shown the ones in between are just replaced
+class TripleBuffer
+{
+public:
+    //Four planes of 128x64
+    static const int maxDisplayWords = 4 * 64 * 2;
+
+    struct Frame
+    {
+        uint64_t display [maxDisplayWords];
+        int width;
+        int height;
+        int planes;
+    };
+
+    TripleBuffer ()
+    {
+        memset(frames, 0, sizeof(frames));
+        back = 0;
+        middle = 1;
+        front = 2;
+    }
+
+    //Producer side, fill in getBack then publish it
+    Frame& getBack () { return frames[back]; }
+
+    void publish ()
+    {
+        //Hands the finished frame over and takes whatever was in the middle to write next
+        back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //Consumer side, swaps in the newest published frame, false if nothing has been published since last time
+    bool update ()
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+
+        return true;
+    }
+
+    const Frame& getFront () const { return frames[front]; }
+
+private:
+    static const int indexMask = 3;
+    static const int freshBit = 4;
+
+    Frame frames [3];
+
+    //Each only touched by its own side
+    int back;
+    int front;
+    //Index of the frame in between, with freshBit set when the producer put it there
+    std::atomic<int> middle;
+};
+
+#endif /* defined(__Chip8__TripleBuffer__) */
@@ -0,0 +1,277 @@
+//
+//  batch.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Core.h"
+#include "HeadlessInput.h"
+#include "Rom.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+//Headless corpus runner - every ROM gets its own Core, run for a number of frames or until it stops itself,
+//spread over every core of the machine. One line per ROM on stdout, in the order they were given
+
+struct Result
+{
+    string status;
+    long frames;
+    uint64_t cycles;
+    uint64_t displayHash;
+    unsigned short unhandledOpcode;
+    //What the file was, for the index. 0 if it couldn't be read
+    uint64_t romHash;
+    uint64_t size;
+    int64_t modified;
+};
+
+static void usage ()
+{
+    cerr << "Usage: batch [--frames N] [--threads N] [--mode chip8 | schip | xochip] [--quirks LIST] [--quirk-db FILE] [--index FILE [--query]] [--threaded | --recompiler] [--ips N] [--key HEXKEY] ROM|DIRECTORY|@LISTFILE..." << endl;
+    exit(1);
+}
+
+//What the index knows about each ROM, one line each, without reading or running any of them. Quirks come from the
+//database, "-" if it doesn't have the ROM
+static void query (const RomIndex& index, const QuirkDatabase& database, const vector<string>& roms)
+{
+    printf("rom\ttitle\tmode\tquirks\tips\tstatus\tframes\tcycles\tdisplay\n");
+
+    for (const string& rom : roms)
+    {
+        uint64_t romHash;
+
+        if (!index.findPath(rom, romHash))
+        {
+            printf("%s\t-\t-\t-\t-\tunindexed\t-\t-\t-\n", rom.c_str());
+            continue;
+        }
+
+        const RomEntry& entry = *index.find(romHash);
+        uint8_t quirks;
+        bool known = database.find(romHash, quirks);
+
+        printf("%s\t%s\t%s\t%s\t%d\t%s\t%ld\t%llu\t%016llx\n", rom.c_str(), entry.title.c_str(),
+               entry.mode >= 0 ? getModeName((Mode) entry.mode) : "-",
+               known ? formatQuirks(quirks).c_str() : "-", entry.instructionRate,
+               entry.status.empty() ? "-" : entry.status.c_str(), entry.frames,
+               (unsigned long long) entry.cycles, (unsigned long long) entry.displayHash);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    long frames = 60 * 60;
+    int threads = 0;
+    int instructionRate = 0;
+    //Fx0A answer, -1 leaves ROMs waiting
+    int autoKey = -1;
+    Dispatch dispatch = DISPATCH_THREADED;
+    Mode mode = MODE_CHIP8;
+    bool modeGiven = false;
+    uint8_t quirks = 0;
+    bool quirksGiven = false;
+    QuirkDatabase database;
+    RomIndex index;
+    const char* indexLocation = nullptr;
+    bool queryOnly = false;
+    vector<string> roms;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "--frames" && i + 1 < argc)
+            frames = atol(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (arg == "--ips" && i + 1 < argc)
+            instructionRate = atoi(argv[++i]);
+        else if (arg == "--key" && i + 1 < argc)
+            autoKey = (int) strtol(argv[++i], nullptr, 16) & 0xF;
+        else if (arg == "--mode" && i + 1 < argc)
+        {
+            if (!parseMode(argv[++i], mode))
+                usage();
+
+            modeGiven = true;
+        }
+        else if (arg == "--quirks" && i + 1 < argc)
+        {
+            if (!parseQuirks(argv[++i], quirks))
+                usage();
+
+            quirksGiven = true;
+        }
+        else if (arg == "--quirk-db" && i + 1 < argc)
+        {
+            if (!database.load(argv[++i]))
+            {
+                cerr << "Error reading " << argv[i] << endl;
+                exit(1);
+            }
+        }
+        else if (arg == "--index" && i + 1 < argc)
+        {
+            indexLocation = argv[++i];
+
+            if (!index.load(indexLocation))
+            {
+                cerr << "Error reading " << indexLocation << endl;
+                exit(1);
+            }
+        }
+        else if (arg == "--query")
+            queryOnly = true;
+        else if (arg == "--threaded")
+            dispatch = DISPATCH_THREADED;
+        else if (arg == "--recompiler")
+            dispatch = DISPATCH_RECOMPILER;
+        else if (arg[0] == '@')
+        {
+            if (!addROMList(arg.substr(1), roms))
+            {
+                cerr << "Error opening list " << arg.substr(1) << endl;
+                exit(1);
+            }
+        }
+        else if (arg[0] == '-')
+            usage();
+        else
+            addROMPath(arg, roms);
+    }
+
+    if (roms.empty() || (queryOnly && indexLocation == nullptr))
+        usage();
+
+    if (queryOnly)
+    {
+        query(index, database, roms);
+        return 0;
+    }
+
+    vector<Result> results(roms.size());
+    ThreadPool pool(threads);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    pool.run(roms.size(), [&] (size_t i)
+    {
+        Result& result = results[i];
+        Core core;
+        AutoKeyInput input(autoKey);
+        MappedROM rom(roms[i].c_str(), Core::maxROMSize);
+
+        result.status = "error";
+        result.frames = 0;
+        result.cycles = 0;
+        result.displayHash = 0;
+        result.unhandledOpcode = 0;
+        result.romHash = 0;
+
+        if (rom.getData() == nullptr)
+            return;
+
+        //Found by contents, so a ROM that's been moved or renamed still gets its settings. Only read from here on,
+        //so every thread can look in the index and database at once
+        result.romHash = hashROM(rom.getData(), rom.getSize());
+        result.size = rom.getSize();
+        result.modified = rom.getModified();
+
+        const RomEntry* entry = index.find(result.romHash);
+        uint8_t known;
+
+        //Given outright, then whatever the index or database says, then the defaults
+        core.setMode(modeGiven || entry == nullptr || entry->mode < 0 ? mode : (Mode) entry->mode);
+        core.setDispatch(dispatch);
+
+        //Without an Input a ROM stuck on Fx0A halts straight away instead of using up its frames
+        if (autoKey >= 0)
+            core.setInput(&input);
+
+        if (instructionRate > 0)
+            core.setInstructionRate(instructionRate);
+        else if (entry != nullptr && entry->instructionRate > 0)
+            core.setInstructionRate(entry->instructionRate);
+
+        if (!core.loadROM(rom.getData(), rom.getSize()))
+            return;
+
+        if (quirksGiven)
+            core.setQuirks(quirks);
+        else if (database.find(result.romHash, known))
+            core.setQuirks(known);
+
+        result.frames = core.run(frames);
+        result.cycles = core.getCycles();
+        result.displayHash = core.hashDisplay();
+        result.unhandledOpcode = core.getUnhandledOpcode();
+
+        switch (core.getStatus())
+        {
+            case STATUS_RUNNING:
+                result.status = "running";
+                break;
+            case STATUS_HALTED:
+                result.status = core.isWaitingForKey() ? "waiting" : "halted";
+                break;
+            case STATUS_UNHANDLED_OPCODE:
+                result.status = "unhandled";
+                break;
+        }
+    });
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    uint64_t totalCycles = 0;
+
+    printf("rom\tstatus\tframes\tcycles\tdisplay\tunhandled\n");
+
+    for (size_t i = 0; i < roms.size(); i++)
+    {
+        const Result& result = results[i];
+        totalCycles += result.cycles;
+
+        printf("%s\t%s\t%ld\t%llu\t%016llx\t", roms[i].c_str(), result.status.c_str(), result.frames,
+               (unsigned long long) result.cycles, (unsigned long long) result.displayHash);
+
+        if (result.status == "unhandled")
+            printf("%04x\n", result.unhandledOpcode);
+        else
+            printf("-\n");
+    }
+
+    if (indexLocation != nullptr)
+    {
+        for (size_t i = 0; i < roms.size(); i++)
+        {
+            const Result& result = results[i];
+
+            if (result.romHash == 0)
+                continue;
+
+            RomEntry& entry = index.add(result.romHash, roms[i], result.size, result.modified);
+
+            entry.status = result.status;
+            entry.frames = result.frames;
+            entry.cycles = result.cycles;
+            entry.displayHash = result.displayHash;
+        }
+
+        if (!index.save(indexLocation))
+            cerr << "Error writing " << indexLocation << endl;
+    }
+
+    cerr << roms.size() << " ROMs on " << pool.getThreadCount() << " threads in " << elapsed << "s, "
+         << roms.size() / elapsed << " ROMs/s, " << totalCycles / elapsed / 1e6 << " M instructions/s" << endl;
+
+    return 0;
+}
@@ -0,0 +1,414 @@
+//
+//  bench.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "BenchRoms.h"
+#include "Core.h"
+#include "Lockstep.h"
+#include "ReferenceCore.h"
+#include "Rom.h"
+
+using namespace std;
+using namespace std::chrono;
+
+static double secondsSince (steady_clock::time_point start)
+{
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+//Frames until frames have run or it stops, the same loop for either machine
+template <typename Machine>
+static double runFrames (Machine& machine, long frames)
+{
+    steady_clock::time_point start = steady_clock::now();
+
+    for (long frame = 0; frame < frames && machine.getStatus() == STATUS_RUNNING; frame++)
+        machine.emulateFrame();
+
+    return secondsSince(start);
+}
+
+//The old getHex switch interpreter (the ReferenceCore) against the decode table, whole interpreters running the same
+//ROM so neither side's decode can be folded away on its own. Idle skipping is off, the ReferenceCore doesn't have it
+static void benchReference (const char* location, long frames, int cyclesPerFrame)
+{
+    MappedROM rom(location, Core::maxROMSize);
+    ReferenceCore reference;
+    Core core;
+
+    if (rom.getData() == nullptr || !reference.loadROM(rom.getData(), rom.getSize()) || !core.loadROM(rom.getData(), rom.getSize()))
+        exit(1);
+
+    reference.setInstructionRate(cyclesPerFrame * core.getTimerRate());
+    core.setInstructionRate(cyclesPerFrame * core.getTimerRate());
+    core.setIdleSkip(false);
+
+    double referenceTime = runFrames(reference, frames);
+    double tableTime = runFrames(core, frames);
+
+    printf("%-8s %llu instructions in %.3fs   %8.1f M instructions/s\n",
+           "getHex", (unsigned long long) reference.getCycles(), referenceTime, reference.getCycles() / referenceTime / 1e6);
+    printf("%-8s %llu instructions in %.3fs   %8.1f M instructions/s (idle skip off)\n",
+           "table", (unsigned long long) core.getCycles(), tableTime, core.getCycles() / tableTime / 1e6);
+}
+
+static void benchRun (const char* location, long frames, int cyclesPerFrame, Dispatch dispatch, const char* name)
+{
+    Core core;
+
+    if (!core.loadFile(location))
+        exit(1);
+
+    core.setCyclesPerFrame(cyclesPerFrame);
+    core.setDispatch(dispatch);
+
+    steady_clock::time_point start = steady_clock::now();
+    core.run(frames);
+    double elapsed = secondsSince(start);
+
+    printf("%-8s %llu instructions in %.3fs   %8.1f M instructions/s\n",
+           name, (unsigned long long) core.getCycles(), elapsed, core.getCycles() / elapsed / 1e6);
+}
+
+//A seed sweep, every lane runs the whole ROM so the total is comparable with the single Core numbers
+static void benchLockstep (const char* location, long frames, int cyclesPerFrame, int lanes)
+{
+    Lockstep lockstep(lanes);
+
+    if (!lockstep.loadFile(location))
+        exit(1);
+
+    lockstep.setCyclesPerFrame(cyclesPerFrame);
+
+    //Only a share of the frames, it's doing lanes times the work
+    frames = frames / lanes + 1;
+
+    steady_clock::time_point start = steady_clock::now();
+    lockstep.run(frames);
+    double elapsed = secondsSince(start);
+
+    uint64_t total = 0;
+
+    for (int lane = 0; lane < lanes; lane++)
+        total += lockstep.getCycles(lane);
+
+    printf("%-8s %llu instructions in %.3fs   %8.1f M instructions/s (%d lanes)\n",
+           "lockstep", (unsigned long long) total, elapsed, total / elapsed / 1e6, lanes);
+
+    //Each lane should be exactly a headless Core with the same seed and no idle skipping, cycles included
+    int mismatches = 0;
+
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        Core core;
+        core.loadFile(location);
+        core.seed(lane);
+        core.setIdleSkip(false);
+        core.setCyclesPerFrame(cyclesPerFrame);
+        core.run(frames);
+
+        if (core.getCycles() == lockstep.getCycles(lane) && core.getPC() == lockstep.getPC(lane) &&
+            core.getStatus() == lockstep.getStatus(lane) && core.isWaitingForKey() == lockstep.isWaitingForKey(lane) &&
+            core.hashDisplay() == lockstep.hashDisplay(lane))
+            continue;
+
+        if (mismatches++ == 0)
+            printf("lockstep lane %d differs from a Core: pc %03X / %03X, cycles %llu / %llu\n", lane, core.getPC(),
+                   lockstep.getPC(lane), (unsigned long long) core.getCycles(), (unsigned long long) lockstep.getCycles(lane));
+    }
+
+    if (mismatches > 0)
+        printf("lockstep %d of %d lanes differ from a Core\n", mismatches, lanes);
+}
+
+//Does the same conversion as Chip::render into a plain buffer, so the cost of turning the packed display into
+//texture pixels can be measured without a window
+struct PixelVideo : public Video
+{
+    vector<uint32_t> pixels;
+    double seconds = 0;
+    long frames = 0;
+
+    void render (const uint64_t* display, int width, int height, int planes, uint64_t dirtyRows) override
+    {
+        static const uint32_t palette [16] = {
+            0xFF000000, 0xFFFFFFFF, 0xFFAAAAAA, 0xFF555555, 0xFFFF0000, 0xFF00FF00, 0xFF0000FF, 0xFFFFFF00,
+            0xFF880000, 0xFF008800, 0xFF000088, 0xFF888800, 0xFFFF00FF, 0xFF00FFFF, 0xFF880088, 0xFF008888
+        };
+
+        steady_clock::time_point start = steady_clock::now();
+
+        pixels.resize(width * height);
+        int rowWords = width / 64;
+        int planeWords = rowWords * height;
+
+        for (int y = 0; y < height; y++)
+        {
+            if (((dirtyRows >> y) & 1) == 0)
+                continue;
+
+            const uint64_t* row = &display[y * rowWords];
+            uint32_t* out = &pixels[y * width];
+
+            if (planes == 1)
+            {
+                //Black and white, no need to gather bits from other planes
+                for (int x = 0; x < width; x++)
+                    out[x] = palette[(row[x / 64] >> (63 - (x % 64))) & 1];
+            }
+            else
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    int colour = 0;
+
+                    for (int plane = 0; plane < planes; plane++)
+                        colour |= ((row[plane * planeWords + x / 64] >> (63 - (x % 64))) & 1) << plane;
+
+                    out[x] = palette[colour];
+                }
+            }
+        }
+
+        seconds += secondsSince(start);
+        frames++;
+    }
+};
+
+struct SuiteResult
+{
+    string rom;
+    string metric;
+    double value;
+};
+
+static Core* makeCore (const BenchRom& rom)
+{
+    Core* core = new Core();
+    core->setMode(rom.mode);
+
+    if (!core->loadROM(rom.data.data(), rom.data.size()))
+        exit(1);
+
+    return core;
+}
+
+//Best of repeats - anything slower than that was the machine doing something else
+static double best (int repeats, bool lowest, const function<double ()>& measure)
+{
+    double result = measure();
+
+    for (int i = 1; i < repeats; i++)
+    {
+        double value = measure();
+        result = lowest ? min(result, value) : max(result, value);
+    }
+
+    return result;
+}
+
+static vector<SuiteResult> runSuite (long frames, int repeats)
+{
+    const Dispatch dispatches [] = {DISPATCH_TABLE, DISPATCH_THREADED, DISPATCH_RECOMPILER_PORTABLE, DISPATCH_RECOMPILER};
+    const char* names [] = {"table", "threaded", "blocks", "native"};
+
+    vector<SuiteResult> results;
+
+    for (const BenchRom& rom : makeBenchRoms())
+    {
+        //Instructions a second flat out, for each dispatch
+        for (int i = 0; i < 4; i++)
+        {
+            double rate = best(repeats, false, [&] ()
+            {
+                unique_ptr<Core> core(makeCore(rom));
+                core->setCyclesPerFrame(1000);
+                core->setDispatch(dispatches[i]);
+
+                steady_clock::time_point start = steady_clock::now();
+                core->run(frames);
+
+                return core->getCycles() / secondsSince(start) / 1e6;
+            });
+
+            results.push_back({rom.name, string(names[i]) + "_mips", rate});
+        }
+
+        //Frames a second at the normal rate with nothing attached, and what showing every one of them costs
+        double frameRate = best(repeats, false, [&] ()
+        {
+            unique_ptr<Core> core(makeCore(rom));
+            core->setDispatch(DISPATCH_THREADED);
+
+            steady_clock::time_point start = steady_clock::now();
+            long ran = core->run(frames * 10);
+
+            return ran / secondsSince(start);
+        });
+
+        long rendered = 0;
+        double renderCost = best(repeats, true, [&] ()
+        {
+            unique_ptr<Core> core(makeCore(rom));
+            PixelVideo video;
+            core->setVideo(&video);
+            core->setDispatch(DISPATCH_THREADED);
+            core->run(frames);
+
+            rendered = video.frames;
+            return video.frames > 0 ? video.seconds / video.frames * 1e9 : 0;
+        });
+
+        results.push_back({rom.name, "frames_per_s", frameRate});
+
+        //Only the first frame is drawn by ROMs that never change the display, one sample is just noise
+        if (rendered >= 100)
+            results.push_back({rom.name, "render_ns_per_frame", renderCost});
+    }
+
+    return results;
+}
+
+static bool saveResults (const vector<SuiteResult>& results, const char* location)
+{
+    FILE* file = fopen(location, "w");
+
+    if (file == nullptr)
+        return false;
+
+    for (const SuiteResult& result : results)
+        fprintf(file, "%s\t%s\t%.6g\n", result.rom.c_str(), result.metric.c_str(), result.value);
+
+    return fclose(file) == 0;
+}
+
+//Anything more than tolerance worse than the baseline is a regression, render cost is the only one where lower is
+//better. Returns how many there were
+static int compareResults (const vector<SuiteResult>& results, const char* location, double tolerance)
+{
+    ifstream file(location);
+
+    if (!file.is_open())
+    {
+        cerr << "Error opening baseline " << location << endl;
+        exit(1);
+    }
+
+    map<pair<string, string>, double> baseline;
+    string rom, metric;
+    double value;
+
+    while (file >> rom >> metric >> value)
+        baseline[{rom, metric}] = value;
+
+    int regressions = 0;
+
+    for (const SuiteResult& result : results)
+    {
+        auto found = baseline.find({result.rom, result.metric});
+
+        if (found == baseline.end() || found->second <= 0)
+            continue;
+
+        bool lowerIsBetter = result.metric == "render_ns_per_frame";
+        double change = result.value / found->second - 1;
+
+        if ((lowerIsBetter ? change : -change) > tolerance)
+        {
+            printf("REGRESSION %s %s %.6g -> %.6g (%+.1f%%)\n", result.rom.c_str(), result.metric.c_str(), found->second,
+                   result.value, change * 100);
+            regressions++;
+        }
+    }
+
+    return regressions;
+}
+
+static int suiteMain (int argc, char* argv[])
+{
+    long frames = 2000;
+    int repeats = 3;
+    double tolerance = 0.1;
+    const char* saveLocation = nullptr;
+    const char* baselineLocation = nullptr;
+
+    for (int i = 2; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "--frames" && i + 1 < argc)
+            frames = atol(argv[++i]);
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeats = max(1, atoi(argv[++i]));
+        else if (arg == "--save" && i + 1 < argc)
+            saveLocation = argv[++i];
+        else if (arg == "--compare" && i + 1 < argc)
+            baselineLocation = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc)
+            tolerance = atof(argv[++i]) / 100;
+        else if (arg == "--write-roms" && i + 1 < argc)
+        {
+            if (!writeBenchRoms(makeBenchRoms(), argv[++i]))
+            {
+                cerr << "Error writing ROMs to " << argv[i] << endl;
+                return 1;
+            }
+
+            return 0;
+        }
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    vector<SuiteResult> results = runSuite(frames, repeats);
+
+    for (const SuiteResult& result : results)
+        printf("%-8s %-22s %12.2f\n", result.rom.c_str(), result.metric.c_str(), result.value);
+
+    if (saveLocation != nullptr && !saveResults(results, saveLocation))
+        cerr << "Error writing " << saveLocation << endl;
+
+    if (baselineLocation != nullptr && compareResults(results, baselineLocation, tolerance) > 0)
+        return 1;
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 2 && string(argv[1]) == "--suite")
+        return suiteMain(argc, argv);
+
+    if (argc < 2)
+    {
+        cerr << "Usage: bench ROMFILE [FRAMES] [CYCLES_PER_FRAME]" << endl;
+        cerr << "       bench --suite [--frames N] [--repeat N] [--save FILE] [--compare FILE [--tolerance PERCENT]]" << endl;
+        cerr << "       bench --suite --write-roms DIRECTORY" << endl;
+        exit(1);
+    }
+
+    long frames = argc > 2 ? atol(argv[2]) : 20000;
+    int cyclesPerFrame = argc > 3 ? atoi(argv[3]) : 1000;
+
+    benchReference(argv[1], frames, cyclesPerFrame);
+    benchRun(argv[1], frames, cyclesPerFrame, DISPATCH_TABLE, "table");
+    benchRun(argv[1], frames, cyclesPerFrame, DISPATCH_THREADED, "threaded");
+    benchRun(argv[1], frames, cyclesPerFrame, DISPATCH_RECOMPILER_PORTABLE, "blocks");
+    benchRun(argv[1], frames, cyclesPerFrame, DISPATCH_RECOMPILER, "native");
+    benchLockstep(argv[1], frames, cyclesPerFrame, 256);
+
+    return 0;
+}
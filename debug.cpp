@@ -0,0 +1,291 @@
+//
+//  debug.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include <ctype.h>
+#include <sstream>
+#include <string>
+
+#include "Core.h"
+#include "Debugger.h"
+#include "Disassembler.h"
+#include "HeadlessInput.h"
+
+using namespace std;
+
+//Command line debugger for a headless Core, or a plain listing of a ROM with --list. Commands come one a line on
+//stdin, so a script of them can be piped in
+
+static void usage ()
+{
+    cerr << "Usage: debug [--mode chip8 | schip | xochip] [--quirks LIST] [--quirk-db FILE] [--ips N] [--key HEXKEY] [--list] ROMFILE" << endl;
+    exit(1);
+}
+
+static void help ()
+{
+    printf("b ADDR          break when pc gets to ADDR\n"
+           "d [ADDR]        delete the breakpoint at ADDR, or all of them\n"
+           "w ADDR          stop when the byte at ADDR changes\n"
+           "wr VX | I       stop when a register changes\n"
+           "dw              delete every watchpoint\n"
+           "s [N]           step N instructions\n"
+           "n               step over a CALL\n"
+           "f FRAME         run until FRAME starts\n"
+           "c               continue\n"
+           "r               registers\n"
+           "x [ADDR] [N]    N bytes of memory from ADDR, I by default\n"
+           "l [ADDR] [N]    list N instructions from ADDR, pc by default\n"
+           "q               quit\n");
+}
+
+static void printRegisters (const Core& core, const Debugger& debugger)
+{
+    const unsigned char* registers = core.getRegisters();
+
+    for (int i = 0; i < 16; i++)
+        printf("V%X %02X%s", i, registers[i], i == 7 || i == 15 ? "\n" : "  ");
+
+    printf("I %04X  pc %04X  dt %02X  st %02X  frame %ld (%d left)  cycles %llu\n", core.getI(), core.getPC(),
+           core.getDelayTimer(), core.getSoundTimer(), debugger.getFrame(), debugger.getFrameRemaining(),
+           (unsigned long long) core.getCycles());
+}
+
+static void printMemory (const Core& core, unsigned short address, int count)
+{
+    const unsigned char* memory = core.getMemory();
+    size_t mask = core.getMemorySize() - 1;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (i % 16 == 0)
+            printf("%s%04X ", i > 0 ? "\n" : "", (unsigned) ((address + i) & mask));
+
+        printf(" %02X", memory[(address + i) & mask]);
+    }
+
+    printf("\n");
+}
+
+static void list (const Core& core, unsigned short address, int count)
+{
+    char text [32];
+
+    for (int i = 0; i < count; i++)
+    {
+        int size = disassemble(core.getMemory(), core.getMemorySize(), address, core.getMode(), text, sizeof(text));
+
+        printf("%s %04X  %s\n", address == core.getPC() ? ">" : " ", address, text);
+        address += size;
+    }
+}
+
+static void report (Debugger::Stop stop, const Core& core, const Debugger& debugger)
+{
+    switch (stop)
+    {
+        case Debugger::STOP_BREAKPOINT:
+            printf("Breakpoint\n");
+            break;
+        case Debugger::STOP_WATCHPOINT:
+            printf("Watchpoint %s\n", debugger.getWatchHit().c_str());
+            break;
+        case Debugger::STOP_FRAME:
+            printf("Frame %ld\n", debugger.getFrame());
+            break;
+        case Debugger::STOP_HALTED:
+            if (core.getStatus() == STATUS_UNHANDLED_OPCODE)
+                printf("Stopped on unhandled opcode %04X\n", core.getUnhandledOpcode());
+            else
+                printf("Halted\n");
+            break;
+        case Debugger::STOP_STEP:
+            break;
+    }
+
+    list(core, core.getPC(), 1);
+}
+
+static bool parseAddress (istream& in, unsigned short& address)
+{
+    string word;
+
+    if (!(in >> word))
+        return false;
+
+    address = (unsigned short) strtoul(word.c_str(), nullptr, 16);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Mode mode = MODE_CHIP8;
+    uint8_t quirks = 0;
+    bool quirksGiven = false;
+    const char* quirkDatabase = nullptr;
+    int instructionRate = 0;
+    int autoKey = -1;
+    bool listOnly = false;
+
+    if (argc < 2)
+        usage();
+
+    for (int i = 1; i < argc - 1; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "--mode" && i + 2 < argc)
+        {
+            if (!parseMode(argv[++i], mode))
+                usage();
+        }
+        else if (arg == "--quirks" && i + 2 < argc)
+        {
+            if (!parseQuirks(argv[++i], quirks))
+                usage();
+
+            quirksGiven = true;
+        }
+        else if (arg == "--quirk-db" && i + 2 < argc)
+            quirkDatabase = argv[++i];
+        else if (arg == "--ips" && i + 2 < argc)
+            instructionRate = atoi(argv[++i]);
+        else if (arg == "--key" && i + 2 < argc)
+            autoKey = (int) strtol(argv[++i], nullptr, 16) & 0xF;
+        else if (arg == "--list")
+            listOnly = true;
+        else
+            usage();
+    }
+
+    Core core;
+    AutoKeyInput input(autoKey);
+
+    core.setMode(mode);
+
+    if (!core.loadFile(argv[argc - 1]))
+        exit(1);
+
+    if (listOnly)
+    {
+        disassembleRange(stdout, core.getMemory(), core.getMemorySize(), 0x200, (unsigned short) (0x200 + core.getROMSize()), mode);
+        return 0;
+    }
+
+    if (quirkDatabase != nullptr)
+    {
+        QuirkDatabase database;
+        uint8_t known;
+
+        if (!database.load(quirkDatabase))
+            cerr << "Error reading " << quirkDatabase << endl;
+        else if (database.find(core.getROMHash(), known))
+            core.setQuirks(known);
+    }
+
+    if (quirksGiven)
+        core.setQuirks(quirks);
+
+    if (autoKey >= 0)
+        core.setInput(&input);
+
+    if (instructionRate > 0)
+        core.setInstructionRate(instructionRate);
+
+    Debugger debugger(core);
+    string line;
+
+    list(core, core.getPC(), 1);
+    printf("(debug) ");
+    fflush(stdout);
+
+    while (getline(cin, line))
+    {
+        stringstream in(line);
+        string command;
+        unsigned short address;
+        long count;
+
+        in >> command;
+
+        if (command == "q")
+            break;
+        else if (command == "b" && parseAddress(in, address))
+            debugger.setBreakpoint(address);
+        else if (command == "d")
+        {
+            if (parseAddress(in, address))
+                debugger.setBreakpoint(address, false);
+            else
+                debugger.clearBreakpoints();
+        }
+        else if (command == "w" && parseAddress(in, address))
+            debugger.watchMemory(address);
+        else if (command == "wr")
+        {
+            string name;
+            in >> name;
+
+            if (name == "I" || name == "i")
+                debugger.watchRegister(Debugger::registerI);
+            else if (name.size() == 2 && (name[0] == 'V' || name[0] == 'v') && isxdigit(name[1]))
+                debugger.watchRegister((int) strtol(name.c_str() + 1, nullptr, 16));
+            else
+                help();
+        }
+        else if (command == "dw")
+            debugger.clearWatchpoints();
+        else if (command == "s")
+        {
+            if (!(in >> count))
+                count = 1;
+
+            Debugger::Stop stop = Debugger::STOP_STEP;
+
+            for (long i = 0; i < count && stop == Debugger::STOP_STEP; i++)
+                stop = debugger.step();
+
+            report(stop, core, debugger);
+        }
+        else if (command == "n")
+            report(debugger.stepOver(), core, debugger);
+        else if (command == "f" && in >> count)
+            report(debugger.runToFrame(count), core, debugger);
+        else if (command == "c")
+            report(debugger.run(), core, debugger);
+        else if (command == "r")
+            printRegisters(core, debugger);
+        else if (command == "x")
+        {
+            if (!parseAddress(in, address))
+                address = core.getI();
+
+            if (!(in >> count))
+                count = 16;
+
+            printMemory(core, address, (int) count);
+        }
+        else if (command == "l")
+        {
+            if (!parseAddress(in, address))
+                address = core.getPC();
+
+            if (!(in >> count))
+                count = 10;
+
+            list(core, address, (int) count);
+        }
+        else if (!command.empty())
+            help();
+
+        printf("(debug) ");
+        fflush(stdout);
+    }
+
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,301 @@
+//
+//  difftest.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "BenchRoms.h"
+#include "Core.h"
+#include "Differential.h"
+#include "HeadlessInput.h"
+#include "ReferenceCore.h"
+#include "Rom.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+//Differential runner - every ROM goes through the plain handler table and through each faster dispatch side by
+//side, and through the table against the ReferenceCore, and anywhere they disagree is reported down to the
+//instruction. Meant to be run over a whole corpus after any change to the interpreters, exits with 1 if anything
+//disagreed
+
+struct Job
+{
+    size_t rom;
+    Dispatch dispatch;
+    //The table's handlers checked against the ReferenceCore, rather than dispatch against the table
+    bool againstReference;
+
+    string result;
+    long frames;
+    uint64_t cycles;
+    uint64_t trace;
+    unique_ptr<Divergence> divergence;
+};
+
+static const char* getDispatchName (Dispatch dispatch)
+{
+    switch (dispatch)
+    {
+        case DISPATCH_TABLE: return "table";
+        case DISPATCH_THREADED: return "threaded";
+        case DISPATCH_RECOMPILER: return "recompiler";
+        case DISPATCH_RECOMPILER_PORTABLE: return "portable";
+    }
+
+    return "?";
+}
+
+static void usage ()
+{
+    cerr << "Usage: difftest [--frames N] [--threads N] [--mode chip8 | schip | xochip] [--quirks LIST] [--quirk-db FILE] [--ips N] [--key HEXKEY]\n"
+         << "                [--dispatch threaded | recompiler | portable | reference | all] [--checkpoint FRAMES] --suite | ROM|DIRECTORY|@LISTFILE..." << endl;
+    exit(1);
+}
+
+int main(int argc, char* argv[])
+{
+    long frames = 60 * 60;
+    int threads = 0;
+    int instructionRate = 0;
+    int autoKey = -1;
+    long checkpointInterval = 60;
+    Mode mode = MODE_CHIP8;
+    uint8_t quirks = 0;
+    bool quirksGiven = false;
+    bool suite = false;
+    QuirkDatabase database;
+    vector<Dispatch> dispatches = { DISPATCH_THREADED, DISPATCH_RECOMPILER, DISPATCH_RECOMPILER_PORTABLE };
+    bool againstReference = true;
+    vector<string> names;
+    vector<vector<uint8_t>> roms;
+    //--mode for files, the suite's ROMs each say what they're for
+    vector<Mode> modes;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "--frames" && i + 1 < argc)
+            frames = atol(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (arg == "--ips" && i + 1 < argc)
+            instructionRate = atoi(argv[++i]);
+        else if (arg == "--key" && i + 1 < argc)
+            autoKey = (int) strtol(argv[++i], nullptr, 16) & 0xF;
+        else if (arg == "--checkpoint" && i + 1 < argc)
+            checkpointInterval = atol(argv[++i]);
+        else if (arg == "--mode" && i + 1 < argc)
+        {
+            if (!parseMode(argv[++i], mode))
+                usage();
+        }
+        else if (arg == "--quirks" && i + 1 < argc)
+        {
+            if (!parseQuirks(argv[++i], quirks))
+                usage();
+
+            quirksGiven = true;
+        }
+        else if (arg == "--quirk-db" && i + 1 < argc)
+        {
+            if (!database.load(argv[++i]))
+            {
+                cerr << "Error reading " << argv[i] << endl;
+                exit(1);
+            }
+        }
+        else if (arg == "--dispatch" && i + 1 < argc)
+        {
+            string name = argv[++i];
+
+            //Just the one, all is the default
+            againstReference = name == "reference" || name == "all";
+
+            if (name == "threaded")
+                dispatches = { DISPATCH_THREADED };
+            else if (name == "recompiler")
+                dispatches = { DISPATCH_RECOMPILER };
+            else if (name == "portable")
+                dispatches = { DISPATCH_RECOMPILER_PORTABLE };
+            else if (name == "reference")
+                dispatches.clear();
+            else if (name != "all")
+                usage();
+        }
+        else if (arg == "--suite")
+            suite = true;
+        else if (arg[0] == '@')
+        {
+            if (!addROMList(arg.substr(1), names))
+            {
+                cerr << "Error opening list " << arg.substr(1) << endl;
+                exit(1);
+            }
+        }
+        else if (arg[0] == '-')
+            usage();
+        else
+            addROMPath(arg, names);
+    }
+
+    //Read up front so each one is only read once however many dispatches it goes through
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        MappedROM rom(names[i].c_str(), Core::maxROMSize);
+
+        if (rom.getData() != nullptr)
+            roms.push_back(vector<uint8_t>(rom.getData(), rom.getData() + rom.getSize()));
+        else
+            roms.push_back(vector<uint8_t>());
+
+        modes.push_back(mode);
+    }
+
+    if (suite)
+    {
+        for (BenchRom& rom : makeBenchRoms())
+        {
+            names.push_back("suite:" + rom.name);
+            roms.push_back(rom.data);
+            modes.push_back(rom.mode);
+        }
+    }
+
+    if (names.empty())
+        usage();
+
+    vector<Job> jobs;
+
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        for (Dispatch dispatch : dispatches)
+        {
+            jobs.push_back(Job());
+            jobs.back().rom = i;
+            jobs.back().dispatch = dispatch;
+            jobs.back().againstReference = false;
+        }
+        
+        if (againstReference)
+        {
+            jobs.push_back(Job());
+            jobs.back().rom = i;
+            jobs.back().dispatch = DISPATCH_TABLE;
+            jobs.back().againstReference = true;
+        }
+    }
+
+    ThreadPool pool(threads);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    pool.run(jobs.size(), [&] (size_t i)
+    {
+        Job& job = jobs[i];
+        const vector<uint8_t>& rom = roms[job.rom];
+        AutoKeyInput input(autoKey);
+
+        job.result = "error";
+        job.frames = 0;
+        job.cycles = 0;
+        job.trace = 0;
+
+        if (rom.empty())
+            return;
+
+        //The same whichever machine is the reference
+        auto check = [&] (auto& differential)
+        {
+            bool loaded = true;
+
+            differential.setCheckpointInterval(checkpointInterval);
+            differential.setup([&] (auto& core)
+            {
+                uint8_t known;
+
+                core.setMode(modes[job.rom]);
+
+                if (autoKey >= 0)
+                    core.setInput(&input);
+
+                if (instructionRate > 0)
+                    core.setInstructionRate(instructionRate);
+
+                loaded = loaded && core.loadROM(rom.data(), rom.size());
+
+                if (quirksGiven)
+                    core.setQuirks(quirks);
+                else if (database.find(core.getROMHash(), known))
+                    core.setQuirks(known);
+            });
+
+            if (!loaded)
+                return;
+
+            job.result = differential.run(frames) ? "agree" : "diverged";
+            job.frames = differential.getFrames();
+            job.cycles = differential.getReference().getCycles();
+            job.trace = differential.getTraceHash();
+
+            if (differential.getDivergence() != nullptr)
+                job.divergence = unique_ptr<Divergence>(new Divergence(*differential.getDivergence()));
+        };
+
+        if (job.againstReference)
+        {
+            Differential<ReferenceCore> differential(DISPATCH_TABLE);
+            check(differential);
+        }
+        else
+        {
+            Differential<Core> differential(job.dispatch);
+            check(differential);
+        }
+    });
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    uint64_t totalCycles = 0;
+    int diverged = 0;
+
+    printf("rom\tdispatch\tresult\tframes\tcycles\ttrace\n");
+
+    for (const Job& job : jobs)
+    {
+        totalCycles += job.cycles;
+
+        printf("%s\t%s\t%s\t%ld\t%llu\t%016llx\n", names[job.rom].c_str(), job.againstReference ? "reference" : getDispatchName(job.dispatch), job.result.c_str(),
+               job.frames, (unsigned long long) job.cycles, (unsigned long long) job.trace);
+    }
+
+    for (const Job& job : jobs)
+    {
+        if (job.divergence == nullptr)
+            continue;
+
+        const Divergence& divergence = *job.divergence;
+        diverged++;
+
+        printf("\n%s: %s disagrees with %s in frame %ld", names[job.rom].c_str(), getDispatchName(job.dispatch),
+               job.againstReference ? "the ReferenceCore" : "table", divergence.frame);
+
+        if (divergence.instruction >= 0)
+            printf(", instruction %ld (%04x at %04x)\n", divergence.instruction, divergence.opcode, divergence.address);
+        else
+            printf(" outside any instruction, the frame started at %04x\n", divergence.address);
+
+        printDifferences(stdout, divergence.reference, divergence.candidate);
+    }
+
+    cerr << jobs.size() << " runs of " << names.size() << " ROMs on " << pool.getThreadCount() << " threads in " << elapsed << "s, "
+         << totalCycles / elapsed / 1e6 << " M reference instructions/s, " << diverged << " diverged" << endl;
+
+    return diverged > 0 ? 1 : 0;
+}
@@ -10,18 +10,180 @@
 
 using namespace std;
 
+static void usage ()
+{
+    cerr << "Usage: Chip8 [--mode chip8 | schip | xochip] [--quirks shift,memory,jump,clip,vfreset | none] [--quirk-db FILE]\n"
+         << "             [--threaded | --recompiler] [--turbo] [--ips INSTRUCTIONS_PER_SECOND] [--software] [--vsync] [--rewind MEGABYTES (0 = off)]\n"
+         << "             [--profile PREFIX (needs a CHIP8_PROFILE build)]\n"
+         << "             [--audio-driver NAME (dummy = headless)] [--record LOGFILE | --replay LOGFILE] ROMFILE" << endl;
+    exit(1);
+}
+
 int main(int argc, char* argv[])
 {   
-    if (argc != 2)
+    if (argc < 2)
+        usage();
+    
+    //Renderer and audio driver are picked when the window is made, so look for these first
+    bool software = false;
+    bool vsync = false;
+    const char* audioDriver = nullptr;
+    
+    for (int i = 1; i < argc - 1; i++)
     {
-        cerr << "Need 2 args (Chip8 ROMFILE) recieved " << argc << endl;
+        if (strcmp(argv[i], "--software") == 0)
+            software = true;
+        else if (strcmp(argv[i], "--vsync") == 0)
+            vsync = true;
+        else if (strcmp(argv[i], "--audio-driver") == 0 && i + 2 < argc)
+            audioDriver = argv[++i];
+    }
+    
+    Chip chip(software, audioDriver, vsync);
+    Core& core = chip.getCore();
+    
+    const char* recordLocation = nullptr;
+    const char* replayLocation = nullptr;
+    const char* profileLocation = nullptr;
+    const char* quirkDatabase = nullptr;
+    Mode mode = MODE_CHIP8;
+    uint8_t quirks = 0;
+    bool quirksGiven = false;
+    
+    for (int i = 1; i < argc - 1; i++)
+    {
+        if (strcmp(argv[i], "--mode") == 0 && i + 2 < argc)
+        {
+            if (!parseMode(argv[++i], mode))
+                usage();
+        }
+        else if (strcmp(argv[i], "--quirks") == 0 && i + 2 < argc)
+        {
+            if (!parseQuirks(argv[++i], quirks))
+                usage();
+            
+            quirksGiven = true;
+        }
+        else if (strcmp(argv[i], "--quirk-db") == 0 && i + 2 < argc)
+            quirkDatabase = argv[++i];
+        else if (strcmp(argv[i], "--threaded") == 0)
+            core.setDispatch(DISPATCH_THREADED);
+        else if (strcmp(argv[i], "--recompiler") == 0)
+            core.setDispatch(DISPATCH_RECOMPILER);
+        else if (strcmp(argv[i], "--turbo") == 0)
+            core.setTurbo(true);
+        else if (strcmp(argv[i], "--ips") == 0 && i + 2 < argc)
+            core.setInstructionRate(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--rewind") == 0 && i + 2 < argc)
+            chip.setRewindBudget((size_t) atoi(argv[++i]) * 1024 * 1024);
+        else if (strcmp(argv[i], "--record") == 0 && i + 2 < argc)
+            recordLocation = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 2 < argc)
+            replayLocation = argv[++i];
+        else if (strcmp(argv[i], "--profile") == 0 && i + 2 < argc)
+            profileLocation = argv[++i];
+        else if (strcmp(argv[i], "--software") == 0 || strcmp(argv[i], "--vsync") == 0)
+            continue;
+        else if (strcmp(argv[i], "--audio-driver") == 0 && i + 2 < argc)
+            i++;
+        else
+            usage();
+    }
+    
+    InputLog log;
+    
+    //A replay runs in whatever mode it was recorded in
+    if (replayLocation != nullptr)
+    {
+        if (!log.load(replayLocation))
+        {
+            cerr << "Error reading " << replayLocation << endl;
+            exit(1);
+        }
+        
+        mode = log.mode;
+    }
+    
+    //Before the ROM goes in, changing mode resets the machine
+    core.setMode(mode);
+    chip.loadFile(argv[argc - 1]);
+    
+    //The mode's defaults, unless the database knows the ROM better or they were given outright
+    if (quirkDatabase != nullptr)
+    {
+        QuirkDatabase database;
+        uint8_t known;
+        
+        if (!database.load(quirkDatabase))
+            cerr << "Error reading " << quirkDatabase << endl;
+        else if (database.find(core.getROMHash(), known))
+            core.setQuirks(known);
+    }
+    
+    if (quirksGiven)
+        core.setQuirks(quirks);
+    
+    //Half a megabyte of tables, only made when it's asked for and not even compiled in otherwise
+#ifdef CHIP8_PROFILE
+    unique_ptr<Profiler> profiler;
+    
+    if (profileLocation != nullptr)
+    {
+        profiler = make_unique<Profiler>();
+        core.setProfiler(profiler.get());
+    }
+#else
+    if (profileLocation != nullptr)
+    {
+        cerr << "Profiling needs a build with CHIP8_PROFILE defined" << endl;
         exit(1);
     }
+#endif
+    
+    if (recordLocation != nullptr)
+    {
+        //Frames have to line up with polls and nothing may jump the machine around behind the log's back
+        core.setTurbo(false);
+        chip.setRewindBudget(0);
+        
+        log.begin(core);
+        InputRecorder recorder(chip, core, log);
+        core.setInput(&recorder);
+        
+        chip.emulate();
+        
+        recorder.finish();
+        
+        if (!log.save(recordLocation))
+            cerr << "Error writing " << recordLocation << endl;
+    }
+    else if (replayLocation != nullptr)
+    {
+        if (!log.apply(core))
+        {
+            cerr << replayLocation << " isn't a recording of this ROM" << endl;
+            exit(1);
+        }
+        
+        chip.setRewindBudget(0);
+        
+        InputReplayer replayer(core, log, &chip);
+        core.setInput(&replayer);
         
-    Chip chip;
-    chip.loadFile(argv[1]);
-    chip.emulate();
+        chip.emulate();
+        
+        replayer.finish();
+        
+        if (replayer.getMismatchFrame() >= 0)
+            printf("Replay differs from the recording at frame %ld\n", replayer.getMismatchFrame());
+    }
+    else
+        chip.emulate();
+    
+#ifdef CHIP8_PROFILE
+    if (profiler != nullptr && !profiler->save(profileLocation))
+        cerr << "Error writing profile " << profileLocation << endl;
+#endif
     
     return 0;
 }
-
@@ -0,0 +1,173 @@
+//
+//  replay.cpp
+//  Chip8
+//
+//  Created by Andy on 17/10/2026.
+//  Copyright (c) 2015 Andy. All rights reserved.
+//
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Core.h"
+#include "InputLog.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+//Headless regression runner for recordings made with Chip8 --record. Each ROM is replayed against its log as
+//fast as the host goes, checking the display after every frame, spread over every core of the machine
+
+struct Replay
+{
+    string rom;
+    string log;
+
+    string result;
+    long mismatchFrame;
+    uint32_t frames;
+    uint64_t cycles;
+};
+
+static void usage ()
+{
+    cerr << "Usage: replay [--threads N] [--threaded | --recompiler] ROM LOGFILE [ROM LOGFILE]... | @LISTFILE" << endl;
+    cerr << "       LISTFILE has a ROM and its LOGFILE on each line, separated by whitespace" << endl;
+    exit(1);
+}
+
+static void addList (const string& location, vector<Replay>& replays)
+{
+    ifstream list(location);
+
+    if (!list.is_open())
+    {
+        cerr << "Error opening list " << location << endl;
+        exit(1);
+    }
+
+    Replay replay;
+
+    while (list >> replay.rom >> replay.log)
+        replays.push_back(replay);
+}
+
+int main(int argc, char* argv[])
+{
+    int threads = 0;
+    Dispatch dispatch = DISPATCH_THREADED;
+    vector<Replay> replays;
+    vector<string> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "--threads" && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (arg == "--threaded")
+            dispatch = DISPATCH_THREADED;
+        else if (arg == "--recompiler")
+            dispatch = DISPATCH_RECOMPILER;
+        else if (arg[0] == '@')
+            addList(arg.substr(1), replays);
+        else if (arg[0] == '-')
+            usage();
+        else
+            paths.push_back(arg);
+    }
+
+    if (paths.size() % 2 != 0)
+        usage();
+
+    for (size_t i = 0; i < paths.size(); i += 2)
+    {
+        Replay replay;
+        replay.rom = paths[i];
+        replay.log = paths[i + 1];
+        replays.push_back(replay);
+    }
+
+    if (replays.empty())
+        usage();
+
+    ThreadPool pool(threads);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    pool.run(replays.size(), [&] (size_t i)
+    {
+        Replay& replay = replays[i];
+        Core core;
+        InputLog log;
+
+        replay.mismatchFrame = -1;
+        replay.frames = 0;
+        replay.cycles = 0;
+
+        core.setDispatch(dispatch);
+
+        if (!log.load(replay.log.c_str()))
+        {
+            replay.result = "error";
+            return;
+        }
+
+        //The mode decides where the ROM can go, so it has to be set first
+        core.setMode(log.mode);
+
+        if (!core.loadFile(replay.rom.c_str()))
+        {
+            replay.result = "error";
+            return;
+        }
+
+        if (!log.apply(core))
+        {
+            replay.result = "wrong-rom";
+            return;
+        }
+
+        InputReplayer replayer(core, log);
+        core.setInput(&replayer);
+        core.run();
+        replayer.finish();
+
+        replay.mismatchFrame = replayer.getMismatchFrame();
+        replay.frames = replayer.getFrame();
+        replay.cycles = core.getCycles();
+
+        if (replay.mismatchFrame >= 0)
+            replay.result = "mismatch";
+        else if (replayer.isComplete())
+            replay.result = "ok";
+        else
+            //Stopped before the recording did
+            replay.result = "short";
+    });
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    uint64_t totalFrames = 0;
+    int failed = 0;
+
+    printf("rom\tlog\tresult\tframes\tcycles\tmismatch\n");
+
+    for (const Replay& replay : replays)
+    {
+        totalFrames += replay.frames;
+        failed += replay.result != "ok";
+
+        printf("%s\t%s\t%s\t%u\t%llu\t", replay.rom.c_str(), replay.log.c_str(), replay.result.c_str(), replay.frames,
+               (unsigned long long) replay.cycles);
+
+        if (replay.mismatchFrame >= 0)
+            printf("%ld\n", replay.mismatchFrame);
+        else
+            printf("-\n");
+    }
+
+    cerr << replays.size() << " replays, " << failed << " failed, " << elapsed << "s, "
+         << totalFrames / elapsed / 1e6 << " M frames/s" << endl;
+
+    return failed > 0 ? 1 : 0;
+}